@@ -15,6 +15,15 @@ namespace EmuConst {
   inline constexpr int SCALED_SCREEN_WIDTH = SCREEN_WIDTH * SCALE_FACTOR;
   inline constexpr int SCALED_SCREEN_HEIGHT = SCREEN_HEIGHT * SCALE_FACTOR;
 
+  // NTSC CPU clock in Hz
+  inline constexpr double CPU_FREQUENCY = 1789773.0;
+
+  // NTSC frame rate in Hz, 60.0988. A frame is 341 * 262 PPU cycles, one less every other frame while rendering
+  inline constexpr double FRAME_RATE = CPU_FREQUENCY * 3 / (341 * 262 - 0.5);
+
+  // CPU cycles the front ends emulate per frame, running until more than FRAME_CYCLES - 1 cycles have passed
+  inline constexpr uint64_t FRAME_CYCLES = 29834;
+
   inline constexpr std::array<uint32_t, 64> colors{
     0x626262, 0x001FB2, 0x2404C8, 0x5200B2, 0x730076, 0x800024, 0x730B00, 0x522800,
     0x244400, 0x005700, 0x005c00, 0x005324, 0x003c76, 0x000000, 0x000000, 0x000000,
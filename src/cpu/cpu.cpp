@@ -1,82 +1,365 @@
 #include "cpu.h"
 #include <cstdio>
+#include <algorithm>
 
 // Main Operation
-CPU::CPU(PPU& ppu, InputHandler& inputHandler) : ppu{ppu}, inputHandler{inputHandler},
-memory(0xFFFF), programCounter{}, stackPointer{}, accumulator{}, x{}, y{},
+CPU::CPU(PPU& ppu, InputHandler& inputHandler) : totalCycle{START_CYCLE}, instructionCount{}, skippedCycles{},
+memory(0x10000), ppu{ppu}, inputHandler{inputHandler}, programCounter{}, stackPointer{}, accumulator{}, x{}, y{},
 carry{}, zero{}, interruptDisable{}, decimal{}, breakCommand{}, overflow{}, negative{},
-cycle{}, totalCycle{7} {}
+cycle{}, isNMIHappening{false}, traceBuffer{}, hostStats{}, readPages{}, writePages{},
+blockLookup(0x10000, BLOCK_NOT_DECODED), decodedBlocks{}, blocksInvalidated{false} {
+  initPages();
+  ppu.attachScheduler(scheduler);
+}
 
 void CPU::executeStartUpSequence() {
-  programCounter = memory[0xFFFC] + (memory[0xFFFC + 1] << 8);
+  programCounter = peekMemory(0xFFFC) + (peekMemory(0xFFFC + 1) << 8);
   stackPointer -= 3;
   interruptDisable = true;
 }
 
 void CPU::executeNextClock() {
-  static bool isNMIHappening{false};
+  if (getPPUClock() >= scheduler.getNextEventTime() && handleEvents())
+    return;
+
+  if (totalCycle > 831547)
+    int i{};
+
+  const Byte opcode{ peekMemory(programCounter) };
+  if (traceBuffer)
+    recordTrace(opcode);
+#ifdef NES_PROFILER
+  const Word pc{ programCounter };
+#endif
+
+  instructionCount++;
+  OpInfo op{ opInfo[opcode] };
+  // Register accesses during the instruction see the PPU at the end of its base cycles
+  totalCycle += op.cycle;
+
+  bool res = opHandlers[opcode](*this, peekMemory(programCounter + 1), peekMemory(programCounter + 2));
+
+  totalCycle += cycle;
+#ifdef NES_PROFILER
+  profiler.record(pc, opcode, op.cycle + cycle);
+#endif
+  cycle = 0;
+
+  if (res)
+    programCounter += op.length;
+
+
+  // Testing
+//  OpInfo op{ opInfo[memory[programCounter]] };
+//  cycle = op.cycle;
+//  bool res = executeOp(memory[programCounter], memory[programCounter + 1], memory[programCounter + 2]);
+//  if (res)
+//    programCounter += op.length;
+}
+
+
+void CPU::run(uint64_t untilCycle) {
+  HostStats::Scope scope{hostStats, Subsystem::CPU};
+  while (totalCycle < untilCycle) {
+    const DecodedBlock* block{ canRunDecoded() ? findBlock(programCounter) : nullptr };
+    if (!block)
+      executeNextClock();
+    else if (block->isIdleLoop)
+      executeIdleLoop(*block, untilCycle);
+    else
+      executeBlock(*block, untilCycle);
+  }
+}
+
+bool CPU::handleEvents() {
+  // The PPU events only need the PPU caught up, running it posts the next vblank events again and an NMI event
+  // if the vblank flag or NMI enable changed on the way
+  syncPPU();
+  scheduler.cancel(EventType::NMI);
 
   // Real Operation
   // Checking for NMI
   // ppu cycle must be larger than 2 because 0 & 1 cycle does not generate NMI so
   // the 2 cycle instruction still execute as per usual (instruction for 2 cycle is fetched at the 1 cycle)
   // NMI is only checked at instruction fetching
-  if ((ppu.readPPUStatusNoSideEffect() & 0b1000'0000) && (ppu.readPPUCtrlNoSideEffect() & 0b1000'0000) && !isNMIHappening && ppu.cycle > 2) {
+  if (isNMIPending() && ppu.cycle > 2) {
     memory[0x100 + stackPointer] = programCounter >> 8;
     memory[0x100 + static_cast<Byte>(stackPointer - 1)] = programCounter;
     memory[0x100 + static_cast<Byte>(stackPointer - 2)] = convertFlag();
     stackPointer -= 3;
-    programCounter = memory[0xFFFA] + (memory[0xFFFB] << 8);
+    programCounter = peekMemory(0xFFFA) + (peekMemory(0xFFFB) << 8);
     totalCycle += 7;
-    for (int i{}; i < 21; i++)
-      ppu.executeNextClock();
+#ifdef NES_PROFILER
+    profiler.recordNMI(7);
+#endif
     isNMIHappening = true;
-    return;
+    return true;
   }
 
   if (isNMIHappening && !(ppu.readPPUStatusNoSideEffect() & 0b1000'0000)) {
     isNMIHappening = false;
   }
 
-  if (totalCycle > 831547)
-    int i{};
+  // An NMI that cannot be taken yet is checked again before the next instruction
+  if (isNMIPending())
+    scheduler.schedule(EventType::NMI, getPPUClock());
 
-  // printf("%04X  %02X %02X %02X   A:%02X X:%02X Y:%02X P:%02X SP:%02X   PPU:%03d,%03d  CYC: %llu  Frame: %d  v = %04X\n", programCounter, memory[programCounter], memory[programCounter + 1], memory[programCounter + 2], accumulator, x, y, convertFlag(), stackPointer, ppu.cycle + 1, ppu.scanline, totalCycle, ppu.frame, ppu.v);
+  return false;
+}
 
-  OpInfo op{ opInfo[memory[programCounter]] };
-  totalCycle += op.cycle;
+Scheduler& CPU::getScheduler() {
+  return scheduler;
+}
 
-  for (int i{}; i < op.cycle * 3; i++)
-    ppu.executeNextClock();
+void CPU::syncPPU() {
+  HostStats::Scope scope{hostStats, Subsystem::PPU};
+  ppu.runUntil(getPPUClock());
+}
 
-  bool res = executeOp(memory[programCounter], memory[programCounter + 1], memory[programCounter + 2]);
+void CPU::setTraceBuffer(TraceBuffer* trace) {
+  traceBuffer = trace;
+}
 
-  for (int i{}; i < cycle * 3; i++)
-    ppu.executeNextClock();
-  totalCycle += cycle;
-  cycle = 0;
+void CPU::setHostStats(HostStats* stats) {
+  hostStats = stats;
+  ppu.setHostStats(stats);
+}
 
-  if (res)
-    programCounter += op.length;
+#ifdef NES_PROFILER
+const ExecutionProfiler& CPU::getProfiler() const {
+  return profiler;
+}
+
+void CPU::resetProfiler() {
+  profiler.reset();
+}
+#endif
+
+void CPU::recordTrace(Byte opcode) {
+  int ppuScanline;
+  int ppuCycle;
+  ppu.projectPosition(getPPUClock(), ppuScanline, ppuCycle);
+
+  traceBuffer->record({
+    totalCycle, programCounter, opcode, peekMemory(programCounter + 1), peekMemory(programCounter + 2),
+    accumulator, x, y, convertFlag(), stackPointer,
+    static_cast<int16_t>(ppuScanline), static_cast<int16_t>(ppuCycle)
+  });
+}
 
+bool CPU::isNMIPending() const {
+  return (ppu.readPPUStatusNoSideEffect() & 0b1000'0000) && (ppu.readPPUCtrlNoSideEffect() & 0b1000'0000) && !isNMIHappening;
+}
 
-  // Testing
-//  OpInfo op{ opInfo[memory[programCounter]] };
-//  cycle = op.cycle;
-//  bool res = executeOp(memory[programCounter], memory[programCounter + 1], memory[programCounter + 2]);
-//  if (res)
-//    programCounter += op.length;
+uint64_t CPU::getPPUClock() const {
+  return (totalCycle - START_CYCLE) * 3;
+}
+
+
+
+// Decoded Block Cache
+bool CPU::canRunDecoded() const {
+  return getPPUClock() < scheduler.getNextEventTime() && !traceBuffer;
+}
+
+bool CPU::isReadOnly(Word addr) const {
+  return readPages[addr >> 8] && !writePages[addr >> 8];
+}
+
+const CPU::DecodedBlock* CPU::findBlock(Word pc) {
+  int32_t index{ blockLookup[pc] };
+  if (index == BLOCK_NOT_DECODED) {
+    index = decodeBlock(pc);
+    blockLookup[pc] = index;
+  }
+
+  return index == BLOCK_UNCACHEABLE ? nullptr : &decodedBlocks[index];
+}
+
+int32_t CPU::decodeBlock(Word pc) {
+  const Word start{ pc };
+  DecodedBlock block{};
+  while (block.count < MAX_BLOCK_LENGTH) {
+    // All 3 bytes are passed to the handler, so all of them must be unable to change
+    if (!isReadOnly(pc) || !isReadOnly(pc + 1) || !isReadOnly(pc + 2))
+      break;
+
+    const Byte opcode{ peekMemory(pc) };
+    const OpInfo info{ opInfo[opcode] };
+    if (info.length == 0)
+      break;
+
+    block.ops[block.count] = {
+      opHandlers[opcode], peekMemory(pc + 1), peekMemory(pc + 2),
+      static_cast<Byte>(info.length), static_cast<Byte>(info.cycle), opcode, pc
+    };
+    block.count++;
+
+    // Branch, JMP, JSR, RTS, RTI and BRK set programCounter themselves
+    if ((opcode & 0x1F) == 0x10 || opcode == 0x4C || opcode == 0x6C || opcode == 0x20 ||
+        opcode == 0x60 || opcode == 0x40 || opcode == 0x00)
+      break;
+
+    pc += info.length;
+  }
+
+  if (block.count == 0)
+    return BLOCK_UNCACHEABLE;
+
+  block.isIdleLoop = isIdleLoop(start, block.count);
+  decodedBlocks.push_back(block);
+  return static_cast<int32_t>(decodedBlocks.size() - 1);
+}
+
+void CPU::executeBlock(const DecodedBlock& block, uint64_t untilCycle) {
+  for (int i{}; i < block.count; i++) {
+    if (i > 0 && (totalCycle >= untilCycle || !canRunDecoded()))
+      return;
+
+    const DecodedOp& op{ block.ops[i] };
+    instructionCount++;
+    totalCycle += op.cycle;
+
+    bool res = op.handler(*this, op.arg1, op.arg2);
+
+    totalCycle += cycle;
+#ifdef NES_PROFILER
+    profiler.record(op.pc, op.opcode, op.cycle + cycle);
+#endif
+    cycle = 0;
+
+    if (res)
+      programCounter += op.length;
+
+    if (blocksInvalidated) {
+      blocksInvalidated = false;
+      return;
+    }
+  }
+}
+
+bool CPU::isIdleLoop(Word start, int count) const {
+  bool readsVBlankFlag{ false };
+  Word pc{ start };
+  for (int i{}; i < count - 1; i++) {
+    const Byte opcode{ peekMemory(pc) };
+    const Word addr{ static_cast<Word>(peekMemory(pc + 1) + (peekMemory(pc + 2) << 8)) };
+    switch (opcode) {
+      // LDA, LDX, LDY, CMP, CPX, CPY immediate
+      case 0xA9: case 0xA2: case 0xA0: case 0xC9: case 0xE0: case 0xC0:
+      // LDA, LDX, LDY, CMP, CPX, CPY, BIT zero page
+      case 0xA5: case 0xA6: case 0xA4: case 0xC5: case 0xE4: case 0xC4: case 0x24:
+        break;
+      // LDA, BIT absolute, the only I/O register allowed is PPUSTATUS
+      case 0xAD: case 0x2C:
+        if (addr == 0x2002) {
+          readsVBlankFlag = true;
+          break;
+        }
+        if (!readPages[addr >> 8])
+          return false;
+        break;
+      // LDX, LDY, CMP, CPX, CPY absolute
+      case 0xAE: case 0xAC: case 0xCD: case 0xEC: case 0xCC:
+        if (!readPages[addr >> 8])
+          return false;
+        break;
+      default:
+        return false;
+    }
+    pc += opInfo[opcode].length;
+  }
+
+  const Byte opcode{ peekMemory(pc) };
+  Word target{};
+  if ((opcode & 0x1F) == 0x10)
+    target = pc + 2 + static_cast<int8_t>(peekMemory(pc + 1));
+  else if (opcode == 0x4C)
+    target = peekMemory(pc + 1) + (peekMemory(pc + 2) << 8);
+  else
+    return false;
+
+  // Reading PPUSTATUS also returns sprite 0 hit and overflow, which change without a PPU event, so only
+  // loops on the vblank flag (BPL, BMI) are safe. LDA / BIT overwrite everything they set on every iteration
+  if (readsVBlankFlag && opcode != 0x10 && opcode != 0x30)
+    return false;
+
+  return target == start;
+}
+
+void CPU::executeIdleLoop(const DecodedBlock& block, uint64_t untilCycle) {
+  const Word start{ programCounter };
+  const uint64_t startCycle{ totalCycle };
+  const uint64_t startInstruction{ instructionCount };
+  executeBlock(block, untilCycle);
+
+  // Only once an iteration has run in full and looped back is the next one known to be identical
+  if (programCounter != start || instructionCount - startInstruction != static_cast<uint64_t>(block.count) || !canRunDecoded())
+    return;
+
+  // First CPU cycle at which the PPU reaches its next event
+  const uint64_t eventCycle{ START_CYCLE + (scheduler.getNextEventTime() + 2) / 3 };
+  const uint64_t limit{ std::min(untilCycle, eventCycle) };
+  const uint64_t iterationCycles{ totalCycle - startCycle };
+  if (totalCycle >= limit)
+    return;
+
+  // Leave the last 2 iterations before the limit to be executed, so that reads close to the event and the
+  // final instruction before untilCycle happen for real
+  const uint64_t iterations{ (limit - totalCycle) / iterationCycles };
+  if (iterations <= 2)
+    return;
+
+  totalCycle += (iterations - 2) * iterationCycles;
+  instructionCount += (iterations - 2) * block.count;
+  skippedCycles += (iterations - 2) * iterationCycles;
+
+#ifdef NES_PROFILER
+  // Extra cycles of the iteration (taken branch, page crossing) are put on the instruction closing the loop
+  uint64_t baseCycles{};
+  for (int i{}; i < block.count; i++) {
+    const DecodedOp& op{ block.ops[i] };
+    const uint64_t cycles{ i == block.count - 1 ? iterationCycles - baseCycles : op.cycle };
+    profiler.recordRepeated(op.pc, op.opcode, iterations - 2, (iterations - 2) * cycles);
+    baseCycles += op.cycle;
+  }
+#endif
 }
 
+void CPU::invalidateBlocks() {
+  std::fill(blockLookup.begin(), blockLookup.end(), BLOCK_NOT_DECODED);
+  decodedBlocks.clear();
+  blocksInvalidated = true;
+}
 
 
 // Memory
 Byte CPU::readMemory(Word addr) {
+  const Byte* page{ readPages[addr >> 8] };
+  if (page)
+    return page[addr & 0xFF];
+
+  return readIO(addr);
+}
+
+void CPU::writeMemory(Word addr, Byte input) {
+  Byte* page{ writePages[addr >> 8] };
+  if (page) {
+    page[addr & 0xFF] = input;
+    return;
+  }
+
+  writeIO(addr, input);
+}
+
+Byte CPU::peekMemory(Word addr) const {
+  return getPage(addr >> 8)[addr & 0xFF];
+}
+
+Byte CPU::readIO(Word addr) {
   switch (addr) {
-    case 0x0000 ... 0x1FFF:
-      addr = addr % 0x800;
-      return memory[addr];
     case  0x2000 ... 0x3FFF:
+      syncPPU();
       switch (addr % 0x8) {
         case 0x2:
           return ppu.readPPUStatus();
@@ -103,13 +386,10 @@ Byte CPU::readMemory(Word addr) {
   }
 }
 
-void CPU::writeMemory(Word addr, Byte input) {
+void CPU::writeIO(Word addr, Byte input) {
   switch (addr) {
-    case 0x0000 ... 0x1FFF:
-      addr = addr % 0x800;
-      memory[addr] = input;
-      break;
     case  0x2000 ... 0x3FFF:
+      syncPPU();
       switch (addr % 0x8) {
         case 0x0:
           ppu.writePPUCtrl(input);
@@ -140,7 +420,8 @@ void CPU::writeMemory(Word addr, Byte input) {
     case 0x4000 ... 0x4017:
       switch (addr % 0x4000) {
         case 0x14:
-          ppu.writeOAMDma(memory, input);
+          syncPPU();
+          ppu.writeOAMDma(getPage(input));
           cycle += totalCycle % 2 == 1 ? 513 : 514;
           break;
         case 0x16:
@@ -155,13 +436,48 @@ void CPU::writeMemory(Word addr, Byte input) {
           //printf("APU IO write encountered\n");
       }
       break;
-    default:
+    case 0x4018 ... 0x40FF:
       memory[addr] = input;
-      // printf("writeMemory default encountered @ %04X!\n", addr);
+      break;
+    default:
+      // Read only page (PRG ROM), the write is ignored
       break;
   }
 }
 
+void CPU::initPages() {
+  for (int page{}; page < 256; page++) {
+    switch (page) {
+      case 0x00 ... 0x1F:
+        // 2KB internal RAM mirrored up to $1FFF
+        readPages[page] = &memory[(page % 0x08) * 256];
+        writePages[page] = readPages[page];
+        break;
+      case 0x20 ... 0x40:
+        readPages[page] = nullptr;
+        writePages[page] = nullptr;
+        break;
+      default:
+        readPages[page] = &memory[page * 256];
+        writePages[page] = readPages[page];
+        break;
+    }
+  }
+}
+
+void CPU::mapPages(Byte firstPage, int count, Byte* data, bool writable) {
+  for (int i{}; i < count; i++) {
+    readPages[firstPage + i] = data + i * 256;
+    writePages[firstPage + i] = writable ? readPages[firstPage + i] : nullptr;
+  }
+
+  invalidateBlocks();
+}
+
+const Byte* CPU::getPage(Byte page) const {
+  return readPages[page] ? readPages[page] : &memory[page * 256];
+}
+
 
 
 // Flags
@@ -182,33 +498,39 @@ void CPU::writeFlag(Byte input) {
 
 // OP Handler
 // Load Store
-void CPU::handleLDA(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte)) {
+template <Byte (CPU::*readFn)(Byte, Byte)>
+void CPU::handleLDA(Byte arg1, Byte arg2) {
   accumulator = (this->*readFn)(arg1, arg2);
   zero = accumulator == 0;
   negative = accumulator >= 128;
 }
 
-void CPU::handleLDX(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte)) {
+template <Byte (CPU::*readFn)(Byte, Byte)>
+void CPU::handleLDX(Byte arg1, Byte arg2) {
   x = (this->*readFn)(arg1, arg2);
   zero = x == 0;
   negative = x >= 128;
 }
 
-void CPU::handleLDY(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte)) {
+template <Byte (CPU::*readFn)(Byte, Byte)>
+void CPU::handleLDY(Byte arg1, Byte arg2) {
   y = (this->*readFn)(arg1, arg2);
   zero = y == 0;
   negative = y >= 128;
 }
 
-void CPU::handleSTA(Byte arg1, Byte arg2, void (CPU::*writeFn)(Byte, Byte, Byte)) {
+template <void (CPU::*writeFn)(Byte, Byte, Byte)>
+void CPU::handleSTA(Byte arg1, Byte arg2) {
   (this->*writeFn)(arg1, arg2, accumulator);
 }
 
-void CPU::handleSTX(Byte arg1, Byte arg2, void (CPU::*writeFn)(Byte, Byte, Byte)) {
+template <void (CPU::*writeFn)(Byte, Byte, Byte)>
+void CPU::handleSTX(Byte arg1, Byte arg2) {
   (this->*writeFn)(arg1, arg2, x);
 }
 
-void CPU::handleSTY(Byte arg1, Byte arg2, void (CPU::*writeFn)(Byte, Byte, Byte)) {
+template <void (CPU::*writeFn)(Byte, Byte, Byte)>
+void CPU::handleSTY(Byte arg1, Byte arg2) {
   (this->*writeFn)(arg1, arg2, y);
 }
 
@@ -222,7 +544,8 @@ void CPU::handleBranch(Byte arg, bool flag) {
   }
 }
 
-void CPU::handleASL(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte)) {
+template <Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte)>
+void CPU::handleASL(Byte arg1, Byte arg2) {
   const Byte temp{(this->*readFn)(arg1, arg2) };
   const Byte res{static_cast<Byte>(temp << 1) };
   (this->*writeFn)(arg1, arg2, res);
@@ -231,7 +554,8 @@ void CPU::handleASL(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte), void
   negative = res >= 128;
 }
 
-void CPU::handleLSR(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte)) {
+template <Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte)>
+void CPU::handleLSR(Byte arg1, Byte arg2) {
   const Byte temp{(this->*readFn)(arg1, arg2) };
   const Byte res{static_cast<Byte>(temp >> 1) };
   (this->*writeFn)(arg1, arg2, res);
@@ -240,7 +564,8 @@ void CPU::handleLSR(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte), void
   negative = res >= 128;
 }
 
-void CPU::handleROL(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte)) {
+template <Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte)>
+void CPU::handleROL(Byte arg1, Byte arg2) {
   const Byte temp{(this->*readFn)(arg1, arg2) };
   const Byte res{static_cast<Byte>((temp << 1) + carry) };
   (this->*writeFn)(arg1, arg2, res);
@@ -249,7 +574,8 @@ void CPU::handleROL(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte), void
   negative = res >= 128;
 }
 
-void CPU::handleROR(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte)) {
+template <Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte)>
+void CPU::handleROR(Byte arg1, Byte arg2) {
   const Byte temp{(this->*readFn)(arg1, arg2) };
   const Byte res{static_cast<Byte>((temp >> 1) + (carry << 7)) };
   (this->*writeFn)(arg1, arg2, res);
@@ -258,21 +584,24 @@ void CPU::handleROR(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte), void
   negative = res >= 128;
 }
 
-void CPU::handleINC(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte)) {
+template <Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte)>
+void CPU::handleINC(Byte arg1, Byte arg2) {
   const Byte temp{static_cast<Byte>((this->*readFn)(arg1, arg2) + 1) };
   (this->*writeFn)(arg1, arg2, temp);
   zero = temp == 0;
   negative = temp >= 128;
 }
 
-void CPU::handleDEC(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte)) {
+template <Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte)>
+void CPU::handleDEC(Byte arg1, Byte arg2) {
   const Byte temp{static_cast<Byte>((this->*readFn)(arg1, arg2) - 1) };
   (this->*writeFn)(arg1, arg2, temp);
   zero = temp == 0;
   negative = temp >= 128;
 }
 
-void CPU::handleADC(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte)) {
+template <Byte (CPU::*readFn)(Byte, Byte)>
+void CPU::handleADC(Byte arg1, Byte arg2) {
   const Byte acc{accumulator };
   const Byte add{(this->*readFn)(arg1, arg2) };
   const int res{ accumulator + (this->*readFn)(arg1, arg2) + carry };
@@ -283,7 +612,8 @@ void CPU::handleADC(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte)) {
   negative = accumulator >= 128;
 }
 
-void CPU::handleSBC(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte)) {
+template <Byte (CPU::*readFn)(Byte, Byte)>
+void CPU::handleSBC(Byte arg1, Byte arg2) {
   const Byte acc{accumulator };
   const Byte sub{(this->*readFn)(arg1, arg2) };
   const int res{ accumulator - sub - !carry };
@@ -294,46 +624,53 @@ void CPU::handleSBC(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte)) {
   negative = accumulator >= 128;
 }
 
-void CPU::handleCMP(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte)) {
+template <Byte (CPU::*readFn)(Byte, Byte)>
+void CPU::handleCMP(Byte arg1, Byte arg2) {
   const int res{ accumulator - (this->*readFn)(arg1, arg2) };
   carry = res >= 0;
   zero = res == 0;
   negative = static_cast<Byte>(res) >= 128;
 }
 
-void CPU::handleCPX(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte)) {
+template <Byte (CPU::*readFn)(Byte, Byte)>
+void CPU::handleCPX(Byte arg1, Byte arg2) {
   const int res{ x - (this->*readFn)(arg1, arg2) };
   carry = res >= 0;
   zero = res == 0;
   negative = static_cast<Byte>(res) >= 128;
 }
 
-void CPU::handleCPY(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte)) {
+template <Byte (CPU::*readFn)(Byte, Byte)>
+void CPU::handleCPY(Byte arg1, Byte arg2) {
   const int res{ y - (this->*readFn)(arg1, arg2) };
   carry = res >= 0;
   zero = res == 0;
   negative = static_cast<Byte>(res) >= 128;
 }
 
-void CPU::handleAND(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte)) {
+template <Byte (CPU::*readFn)(Byte, Byte)>
+void CPU::handleAND(Byte arg1, Byte arg2) {
   accumulator &= (this->*readFn)(arg1, arg2);
   zero = accumulator == 0;
   negative = accumulator >= 128;
 }
 
-void CPU::handleEOR(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte)) {
+template <Byte (CPU::*readFn)(Byte, Byte)>
+void CPU::handleEOR(Byte arg1, Byte arg2) {
   accumulator ^= (this->*readFn)(arg1, arg2);
   zero = accumulator == 0;
   negative = accumulator >= 128;
 }
 
-void CPU::handleORA(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte)) {
+template <Byte (CPU::*readFn)(Byte, Byte)>
+void CPU::handleORA(Byte arg1, Byte arg2) {
   accumulator |= (this->*readFn)(arg1, arg2);
   zero = accumulator == 0;
   negative = accumulator >= 128;
 }
 
-void CPU::handleBIT(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte)) {
+template <Byte (CPU::*readFn)(Byte, Byte)>
+void CPU::handleBIT(Byte arg1, Byte arg2) {
   Byte mem{(this->*readFn)(arg1, arg2) };
   zero = (accumulator & mem) == 0;
   overflow = (mem & 0b0100'0000) > 0;
@@ -342,117 +679,118 @@ void CPU::handleBIT(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte)) {
 
 
 
-bool CPU::executeOp(Byte op, Byte arg1, Byte arg2) {
+template <Byte op>
+bool CPU::executeOp(Byte arg1, Byte arg2) {
   switch(op) {
     // Load Store
     // LDA
     case 0xA9:
-      handleLDA(arg1, arg2, &CPU::readImmediate);
+      handleLDA<&CPU::readImmediate>(arg1, arg2);
       break;
     case 0xA5:
-      handleLDA(arg1, arg2, &CPU::readZeroPage);
+      handleLDA<&CPU::readZeroPage>(arg1, arg2);
       break;
     case 0xB5:
-      handleLDA(arg1, arg2, &CPU::readZeroPageX);
+      handleLDA<&CPU::readZeroPageX>(arg1, arg2);
       break;
     case 0xAD:
-      handleLDA(arg1, arg2, &CPU::readAbsolute);
+      handleLDA<&CPU::readAbsolute>(arg1, arg2);
       break;
     case 0xBD:
-      handleLDA(arg1, arg2, &CPU::readAbsoluteX);
+      handleLDA<&CPU::readAbsoluteX>(arg1, arg2);
       break;
     case 0xB9:
-      handleLDA(arg1, arg2, &CPU::readAbsoluteY);
+      handleLDA<&CPU::readAbsoluteY>(arg1, arg2);
       break;
     case 0xA1:
-      handleLDA(arg1, arg2, &CPU::readIndexedIndirect);
+      handleLDA<&CPU::readIndexedIndirect>(arg1, arg2);
       break;
     case 0xB1:
-      handleLDA(arg1, arg2, &CPU::readIndirectIndexed);
+      handleLDA<&CPU::readIndirectIndexed>(arg1, arg2);
       break;
 
 
     // LDX
     case 0xA2:
-      handleLDX(arg1, arg2, &CPU::readImmediate);
+      handleLDX<&CPU::readImmediate>(arg1, arg2);
       break;
     case 0xA6:
-      handleLDX(arg1, arg2, &CPU::readZeroPage);
+      handleLDX<&CPU::readZeroPage>(arg1, arg2);
       break;
     case 0xB6:
-      handleLDX(arg1, arg2, &CPU::readZeroPageY);
+      handleLDX<&CPU::readZeroPageY>(arg1, arg2);
       break;
     case 0xAE:
-      handleLDX(arg1, arg2, &CPU::readAbsolute);
+      handleLDX<&CPU::readAbsolute>(arg1, arg2);
       break;
     case 0xBE:
-      handleLDX(arg1, arg2, &CPU::readAbsoluteY);
+      handleLDX<&CPU::readAbsoluteY>(arg1, arg2);
       break;
 
 
     // LDY
     case 0xA0:
-      handleLDY(arg1, arg2, &CPU::readImmediate);
+      handleLDY<&CPU::readImmediate>(arg1, arg2);
       break;
     case 0xA4:
-      handleLDY(arg1, arg2, &CPU::readZeroPage);
+      handleLDY<&CPU::readZeroPage>(arg1, arg2);
       break;
     case 0xB4:
-      handleLDY(arg1, arg2, &CPU::readZeroPageX);
+      handleLDY<&CPU::readZeroPageX>(arg1, arg2);
       break;
     case 0xAC:
-      handleLDY(arg1, arg2, &CPU::readAbsolute);
+      handleLDY<&CPU::readAbsolute>(arg1, arg2);
       break;
     case 0xBC:
-      handleLDY(arg1, arg2, &CPU::readAbsoluteX);
+      handleLDY<&CPU::readAbsoluteX>(arg1, arg2);
       break;
 
 
     // STA
     case 0x85:
-      handleSTA(arg1, arg2, &CPU::writeZeroPage);
+      handleSTA<&CPU::writeZeroPage>(arg1, arg2);
       break;
     case 0x95:
-      handleSTA(arg1, arg2, &CPU::writeZeroPageX);
+      handleSTA<&CPU::writeZeroPageX>(arg1, arg2);
       break;
     case 0x8D:
-      handleSTA(arg1, arg2, &CPU::writeAbsolute);
+      handleSTA<&CPU::writeAbsolute>(arg1, arg2);
       break;
     case 0x9D:
-      handleSTA(arg1, arg2, &CPU::writeAbsoluteX);
+      handleSTA<&CPU::writeAbsoluteX>(arg1, arg2);
       break;
     case 0x99:
-      handleSTA(arg1, arg2, &CPU::writeAbsoluteY);
+      handleSTA<&CPU::writeAbsoluteY>(arg1, arg2);
       break;
     case 0x81:
-      handleSTA(arg1, arg2, &CPU::writeIndexedIndirect);
+      handleSTA<&CPU::writeIndexedIndirect>(arg1, arg2);
       break;
     case 0x91:
-      handleSTA(arg1, arg2, &CPU::writeIndirectIndexed);
+      handleSTA<&CPU::writeIndirectIndexed>(arg1, arg2);
       break;
 
 
     // STX
     case 0x86:
-      handleSTX(arg1, arg2, &CPU::writeZeroPage);
+      handleSTX<&CPU::writeZeroPage>(arg1, arg2);
       break;
     case 0x96:
-      handleSTX(arg1, arg2, &CPU::writeZeroPageY);
+      handleSTX<&CPU::writeZeroPageY>(arg1, arg2);
       break;
     case 0x8E:
-      handleSTX(arg1, arg2, &CPU::writeAbsolute);
+      handleSTX<&CPU::writeAbsolute>(arg1, arg2);
       break;
 
 
     // STY
     case 0x84:
-      handleSTY(arg1, arg2, &CPU::writeZeroPage);
+      handleSTY<&CPU::writeZeroPage>(arg1, arg2);
       break;
     case 0x94:
-      handleSTY(arg1, arg2, &CPU::writeZeroPageX);
+      handleSTY<&CPU::writeZeroPageX>(arg1, arg2);
       break;
     case 0x8C:
-      handleSTY(arg1, arg2, &CPU::writeAbsolute);
+      handleSTY<&CPU::writeAbsolute>(arg1, arg2);
       break;
 
 
@@ -546,92 +884,92 @@ bool CPU::executeOp(Byte op, Byte arg1, Byte arg2) {
     // Logical
     // AND
     case 0x29:
-      handleAND(arg1, arg2, &CPU::readImmediate);
+      handleAND<&CPU::readImmediate>(arg1, arg2);
       break;
     case 0x25:
-      handleAND(arg1, arg2, &CPU::readZeroPage);
+      handleAND<&CPU::readZeroPage>(arg1, arg2);
       break;
     case 0x35:
-      handleAND(arg1, arg2, &CPU::readZeroPageX);
+      handleAND<&CPU::readZeroPageX>(arg1, arg2);
       break;
     case 0x2D:
-      handleAND(arg1, arg2, &CPU::readAbsolute);
+      handleAND<&CPU::readAbsolute>(arg1, arg2);
       break;
     case 0x3D:
-      handleAND(arg1, arg2, &CPU::readAbsoluteX);
+      handleAND<&CPU::readAbsoluteX>(arg1, arg2);
       break;
     case 0x39:
-      handleAND(arg1, arg2, &CPU::readAbsoluteY);
+      handleAND<&CPU::readAbsoluteY>(arg1, arg2);
       break;
     case 0x21:
-      handleAND(arg1, arg2, &CPU::readIndexedIndirect);
+      handleAND<&CPU::readIndexedIndirect>(arg1, arg2);
       break;
     case 0x31:
-      handleAND(arg1, arg2, &CPU::readIndirectIndexed);
+      handleAND<&CPU::readIndirectIndexed>(arg1, arg2);
       break;
 
 
     // EOR
     case 0x49:
-      handleEOR(arg1, arg2, &CPU::readImmediate);
+      handleEOR<&CPU::readImmediate>(arg1, arg2);
       break;
     case 0x45:
-      handleEOR(arg1, arg2, &CPU::readZeroPage);
+      handleEOR<&CPU::readZeroPage>(arg1, arg2);
       break;
     case 0x55:
-      handleEOR(arg1, arg2, &CPU::readZeroPageX);
+      handleEOR<&CPU::readZeroPageX>(arg1, arg2);
       break;
     case 0x4D:
-      handleEOR(arg1, arg2, &CPU::readAbsolute);
+      handleEOR<&CPU::readAbsolute>(arg1, arg2);
       break;
     case 0x5D:
-      handleEOR(arg1, arg2, &CPU::readAbsoluteX);
+      handleEOR<&CPU::readAbsoluteX>(arg1, arg2);
       break;
     case 0x59:
-      handleEOR(arg1, arg2, &CPU::readAbsoluteY);
+      handleEOR<&CPU::readAbsoluteY>(arg1, arg2);
       break;
     case 0x41:
-      handleEOR(arg1, arg2, &CPU::readIndexedIndirect);
+      handleEOR<&CPU::readIndexedIndirect>(arg1, arg2);
       break;
     case 0x51:
-      handleEOR(arg1, arg2, &CPU::readIndirectIndexed);
+      handleEOR<&CPU::readIndirectIndexed>(arg1, arg2);
       break;
 
 
 
     // ORA
     case 0x09:
-      handleORA(arg1, arg2, &CPU::readImmediate);
+      handleORA<&CPU::readImmediate>(arg1, arg2);
       break;
     case 0x05:
-      handleORA(arg1, arg2, &CPU::readZeroPage);
+      handleORA<&CPU::readZeroPage>(arg1, arg2);
       break;
     case 0x15:
-      handleORA(arg1, arg2, &CPU::readZeroPageX);
+      handleORA<&CPU::readZeroPageX>(arg1, arg2);
       break;
     case 0x0D:
-      handleORA(arg1, arg2, &CPU::readAbsolute);
+      handleORA<&CPU::readAbsolute>(arg1, arg2);
       break;
     case 0x1D:
-      handleORA(arg1, arg2, &CPU::readAbsoluteX);
+      handleORA<&CPU::readAbsoluteX>(arg1, arg2);
       break;
     case 0x19:
-      handleORA(arg1, arg2, &CPU::readAbsoluteY);
+      handleORA<&CPU::readAbsoluteY>(arg1, arg2);
       break;
     case 0x01:
-      handleORA(arg1, arg2, &CPU::readIndexedIndirect);
+      handleORA<&CPU::readIndexedIndirect>(arg1, arg2);
       break;
     case 0x11:
-      handleORA(arg1, arg2, &CPU::readIndirectIndexed);
+      handleORA<&CPU::readIndirectIndexed>(arg1, arg2);
       break;
 
 
     // BIT
     case 0x24:
-      handleBIT(arg1, arg2, &CPU::readZeroPage);
+      handleBIT<&CPU::readZeroPage>(arg1, arg2);
       break;
     case 0x2C:
-      handleBIT(arg1, arg2, &CPU::readAbsolute);
+      handleBIT<&CPU::readAbsolute>(arg1, arg2);
       break;
 
 
@@ -641,106 +979,106 @@ bool CPU::executeOp(Byte op, Byte arg1, Byte arg2) {
     // Arithmetic
     // ADC
     case 0x69:
-      handleADC(arg1, arg2, &CPU::readImmediate);
+      handleADC<&CPU::readImmediate>(arg1, arg2);
       break;
     case 0x65:
-      handleADC(arg1, arg2, &CPU::readZeroPage);
+      handleADC<&CPU::readZeroPage>(arg1, arg2);
       break;
     case 0x75:
-      handleADC(arg1, arg2, &CPU::readZeroPageX);
+      handleADC<&CPU::readZeroPageX>(arg1, arg2);
       break;
     case 0x6D:
-      handleADC(arg1, arg2, &CPU::readAbsolute);
+      handleADC<&CPU::readAbsolute>(arg1, arg2);
       break;
     case 0x7D:
-      handleADC(arg1, arg2, &CPU::readAbsoluteX);
+      handleADC<&CPU::readAbsoluteX>(arg1, arg2);
       break;
     case 0x79:
-      handleADC(arg1, arg2, &CPU::readAbsoluteY);
+      handleADC<&CPU::readAbsoluteY>(arg1, arg2);
       break;
     case 0x61:
-      handleADC(arg1, arg2, &CPU::readIndexedIndirect);
+      handleADC<&CPU::readIndexedIndirect>(arg1, arg2);
       break;
     case 0x71:
-      handleADC(arg1, arg2, &CPU::readIndirectIndexed);
+      handleADC<&CPU::readIndirectIndexed>(arg1, arg2);
       break;
 
 
     // SBC
     case 0xE9:
-      handleSBC(arg1, arg2, &CPU::readImmediate);
+      handleSBC<&CPU::readImmediate>(arg1, arg2);
       break;
     case 0xE5:
-      handleSBC(arg1, arg2, &CPU::readZeroPage);
+      handleSBC<&CPU::readZeroPage>(arg1, arg2);
       break;
     case 0xF5:
-      handleSBC(arg1, arg2, &CPU::readZeroPageX);
+      handleSBC<&CPU::readZeroPageX>(arg1, arg2);
       break;
     case 0xED:
-      handleSBC(arg1, arg2, &CPU::readAbsolute);
+      handleSBC<&CPU::readAbsolute>(arg1, arg2);
       break;
     case 0xFD:
-      handleSBC(arg1, arg2, &CPU::readAbsoluteX);
+      handleSBC<&CPU::readAbsoluteX>(arg1, arg2);
       break;
     case 0xF9:
-      handleSBC(arg1, arg2, &CPU::readAbsoluteY);
+      handleSBC<&CPU::readAbsoluteY>(arg1, arg2);
       break;
     case 0xE1:
-      handleSBC(arg1, arg2, &CPU::readIndexedIndirect);
+      handleSBC<&CPU::readIndexedIndirect>(arg1, arg2);
       break;
     case 0xF1:
-      handleSBC(arg1, arg2, &CPU::readIndirectIndexed);
+      handleSBC<&CPU::readIndirectIndexed>(arg1, arg2);
       break;
 
 
     // CMP
     case 0xC9:
-      handleCMP(arg1, arg2, &CPU::readImmediate);
+      handleCMP<&CPU::readImmediate>(arg1, arg2);
       break;
     case 0xC5:
-      handleCMP(arg1, arg2, &CPU::readZeroPage);
+      handleCMP<&CPU::readZeroPage>(arg1, arg2);
       break;
     case 0xD5:
-      handleCMP(arg1, arg2, &CPU::readZeroPageX);
+      handleCMP<&CPU::readZeroPageX>(arg1, arg2);
       break;
     case 0xCD:
-      handleCMP(arg1, arg2, &CPU::readAbsolute);
+      handleCMP<&CPU::readAbsolute>(arg1, arg2);
       break;
     case 0xDD:
-      handleCMP(arg1, arg2, &CPU::readAbsoluteX);
+      handleCMP<&CPU::readAbsoluteX>(arg1, arg2);
       break;
     case 0xD9:
-      handleCMP(arg1, arg2, &CPU::readAbsoluteY);
+      handleCMP<&CPU::readAbsoluteY>(arg1, arg2);
       break;
     case 0xC1:
-      handleCMP(arg1, arg2, &CPU::readIndexedIndirect);
+      handleCMP<&CPU::readIndexedIndirect>(arg1, arg2);
       break;
     case 0xD1:
-      handleCMP(arg1, arg2, &CPU::readIndirectIndexed);
+      handleCMP<&CPU::readIndirectIndexed>(arg1, arg2);
       break;
 
 
     // CPX
     case 0xE0:
-      handleCPX(arg1, arg2, &CPU::readImmediate);
+      handleCPX<&CPU::readImmediate>(arg1, arg2);
       break;
     case 0xE4:
-      handleCPX(arg1, arg2, &CPU::readZeroPage);
+      handleCPX<&CPU::readZeroPage>(arg1, arg2);
       break;
     case 0xEC:
-      handleCPX(arg1, arg2, &CPU::readAbsolute);
+      handleCPX<&CPU::readAbsolute>(arg1, arg2);
       break;
 
 
     // CPY
     case 0xC0:
-      handleCPY(arg1, arg2, &CPU::readImmediate);
+      handleCPY<&CPU::readImmediate>(arg1, arg2);
       break;
     case 0xC4:
-      handleCPY(arg1, arg2, &CPU::readZeroPage);
+      handleCPY<&CPU::readZeroPage>(arg1, arg2);
       break;
     case 0xCC:
-      handleCPY(arg1, arg2, &CPU::readAbsolute);
+      handleCPY<&CPU::readAbsolute>(arg1, arg2);
       break;
 
 
@@ -750,16 +1088,16 @@ bool CPU::executeOp(Byte op, Byte arg1, Byte arg2) {
     // Increment Decrement
     // INC
     case 0xE6:
-      handleINC(arg1, arg2, &CPU::readZeroPage, &CPU::writeZeroPage);
+      handleINC<&CPU::readZeroPage, &CPU::writeZeroPage>(arg1, arg2);
       break;
     case 0xF6:
-      handleINC(arg1, arg2, &CPU::readZeroPageX, &CPU::writeZeroPageX);
+      handleINC<&CPU::readZeroPageX, &CPU::writeZeroPageX>(arg1, arg2);
       break;
     case 0xEE:
-      handleINC(arg1, arg2, &CPU::readAbsolute, &CPU::writeAbsolute);
+      handleINC<&CPU::readAbsolute, &CPU::writeAbsolute>(arg1, arg2);
       break;
     case 0xFE:
-      handleINC(arg1, arg2, &CPU::readAbsoluteXNoCycle, &CPU::writeAbsoluteX);
+      handleINC<&CPU::readAbsoluteXNoCycle, &CPU::writeAbsoluteX>(arg1, arg2);
       break;
 
 
@@ -781,16 +1119,16 @@ bool CPU::executeOp(Byte op, Byte arg1, Byte arg2) {
 
     // DEC
     case 0xC6:
-      handleDEC(arg1, arg2, &CPU::readZeroPage, &CPU::writeZeroPage);
+      handleDEC<&CPU::readZeroPage, &CPU::writeZeroPage>(arg1, arg2);
       break;
     case 0xD6:
-      handleDEC(arg1, arg2, &CPU::readZeroPageX, &CPU::writeZeroPageX);
+      handleDEC<&CPU::readZeroPageX, &CPU::writeZeroPageX>(arg1, arg2);
       break;
     case 0xCE:
-      handleDEC(arg1, arg2, &CPU::readAbsolute, &CPU::writeAbsolute);
+      handleDEC<&CPU::readAbsolute, &CPU::writeAbsolute>(arg1, arg2);
       break;
     case 0xDE:
-      handleDEC(arg1, arg2, &CPU::readAbsoluteXNoCycle, &CPU::writeAbsoluteX);
+      handleDEC<&CPU::readAbsoluteXNoCycle, &CPU::writeAbsoluteX>(arg1, arg2);
       break;
 
 
@@ -822,16 +1160,16 @@ bool CPU::executeOp(Byte op, Byte arg1, Byte arg2) {
       negative = accumulator >= 128;
       break;
     case 0x06:
-      handleASL(arg1, arg2, &CPU::readZeroPage, &CPU::writeZeroPage);
+      handleASL<&CPU::readZeroPage, &CPU::writeZeroPage>(arg1, arg2);
       break;
     case 0x16:
-      handleASL(arg1, arg2, &CPU::readZeroPageX, &CPU::writeZeroPageX);
+      handleASL<&CPU::readZeroPageX, &CPU::writeZeroPageX>(arg1, arg2);
       break;
     case 0x0E:
-      handleASL(arg1, arg2, &CPU::readAbsolute, &CPU::writeAbsolute);
+      handleASL<&CPU::readAbsolute, &CPU::writeAbsolute>(arg1, arg2);
       break;
     case 0x1E:
-      handleASL(arg1, arg2, &CPU::readAbsoluteXNoCycle, &CPU::writeAbsoluteX);
+      handleASL<&CPU::readAbsoluteXNoCycle, &CPU::writeAbsoluteX>(arg1, arg2);
       break;
 
 
@@ -843,16 +1181,16 @@ bool CPU::executeOp(Byte op, Byte arg1, Byte arg2) {
       negative = accumulator >= 128;
       break;
     case 0x46:
-      handleLSR(arg1, arg2, &CPU::readZeroPage, &CPU::writeZeroPage);
+      handleLSR<&CPU::readZeroPage, &CPU::writeZeroPage>(arg1, arg2);
       break;
     case 0x56:
-      handleLSR(arg1, arg2, &CPU::readZeroPageX, &CPU::writeZeroPageX);
+      handleLSR<&CPU::readZeroPageX, &CPU::writeZeroPageX>(arg1, arg2);
       break;
     case 0x4E:
-      handleLSR(arg1, arg2, &CPU::readAbsolute, &CPU::writeAbsolute);
+      handleLSR<&CPU::readAbsolute, &CPU::writeAbsolute>(arg1, arg2);
       break;
     case 0x5E:
-      handleLSR(arg1, arg2, &CPU::readAbsoluteXNoCycle, &CPU::writeAbsoluteX);
+      handleLSR<&CPU::readAbsoluteXNoCycle, &CPU::writeAbsoluteX>(arg1, arg2);
       break;
 
 
@@ -867,16 +1205,16 @@ bool CPU::executeOp(Byte op, Byte arg1, Byte arg2) {
     }
       break;
     case 0x26:
-      handleROL(arg1, arg2, &CPU::readZeroPage, &CPU::writeZeroPage);
+      handleROL<&CPU::readZeroPage, &CPU::writeZeroPage>(arg1, arg2);
       break;
     case 0x36:
-      handleROL(arg1, arg2, &CPU::readZeroPageX, &CPU::writeZeroPageX);
+      handleROL<&CPU::readZeroPageX, &CPU::writeZeroPageX>(arg1, arg2);
       break;
     case 0x2E:
-      handleROL(arg1, arg2, &CPU::readAbsolute, &CPU::writeAbsolute);
+      handleROL<&CPU::readAbsolute, &CPU::writeAbsolute>(arg1, arg2);
       break;
     case 0x3E:
-      handleROL(arg1, arg2, &CPU::readAbsoluteXNoCycle, &CPU::writeAbsoluteX);
+      handleROL<&CPU::readAbsoluteXNoCycle, &CPU::writeAbsoluteX>(arg1, arg2);
       break;
 
 
@@ -891,16 +1229,16 @@ bool CPU::executeOp(Byte op, Byte arg1, Byte arg2) {
     }
       break;
     case 0x66:
-      handleROR(arg1, arg2, &CPU::readZeroPage, &CPU::writeZeroPage);
+      handleROR<&CPU::readZeroPage, &CPU::writeZeroPage>(arg1, arg2);
       break;
     case 0x76:
-      handleROR(arg1, arg2, &CPU::readZeroPageX, &CPU::writeZeroPageX);
+      handleROR<&CPU::readZeroPageX, &CPU::writeZeroPageX>(arg1, arg2);
       break;
     case 0x6E:
-      handleROR(arg1, arg2, &CPU::readAbsolute, &CPU::writeAbsolute);
+      handleROR<&CPU::readAbsolute, &CPU::writeAbsolute>(arg1, arg2);
       break;
     case 0x7E:
-      handleROR(arg1, arg2, &CPU::readAbsoluteXNoCycle, &CPU::writeAbsoluteX);
+      handleROR<&CPU::readAbsoluteXNoCycle, &CPU::writeAbsoluteX>(arg1, arg2);
       break;
 
 
@@ -1079,4 +1417,33 @@ bool CPU::executeOp(Byte op, Byte arg1, Byte arg2) {
   }
 
   return true;
-}
\ No newline at end of file
+}
+
+
+
+// Dispatch
+template <Byte op>
+bool CPU::dispatchOp(CPU& cpu, Byte arg1, Byte arg2) {
+  return cpu.executeOp<op>(arg1, arg2);
+}
+
+bool CPU::dispatchUnknownOp(CPU& cpu, Byte /*arg1*/, Byte /*arg2*/) {
+  printf("Unknown instruction encountered: OPCODE: %d, skipping!\n", cpu.peekMemory(cpu.programCounter));
+  return true;
+}
+
+template <std::size_t op>
+constexpr CPU::OpHandler CPU::selectOpHandler() {
+  // Opcodes without length in opInfo are not implemented, no need to instantiate executeOp for them
+  if constexpr (opInfo[op].length == 0)
+    return &CPU::dispatchUnknownOp;
+  else
+    return &CPU::dispatchOp<op>;
+}
+
+template <std::size_t... ops>
+constexpr std::array<CPU::OpHandler, 256> CPU::makeOpHandlers(std::index_sequence<ops...>) {
+  return { selectOpHandler<ops>()... };
+}
+
+constexpr std::array<CPU::OpHandler, 256> CPU::opHandlers{ makeOpHandlers(std::make_index_sequence<256>{}) };
\ No newline at end of file
@@ -3,7 +3,14 @@
 
 #include "../ppu/ppu.h"
 #include "../input_handler/input_handler.h"
+#include "trace.h"
+#ifdef NES_PROFILER
+#include "profiler.h"
+#endif
+#include "../scheduler/scheduler.h"
 #include <vector>
+#include <array>
+#include <utility>
 #include <cstdint>
 #include <cmath>
 
@@ -24,14 +31,67 @@ public:
   friend class Initializer;
   explicit CPU(PPU& ppu, InputHandler& inputHandler);
 
+  /**
+   * \brief Not copyable, the page tables point into the memory of the CPU they were made for
+   */
+  CPU(const CPU&) = delete;
+  CPU& operator=(const CPU&) = delete;
+
   void executeStartUpSequence();
   void executeNextClock();
 
+  /**
+   * \brief Execute instructions until totalCycle reaches untilCycle
+   * \note Same result as calling executeNextClock() while totalCycle < untilCycle, but code in read only pages
+   * is run from the decoded block cache
+   */
+  void run(uint64_t untilCycle);
+
+  /**
+   * \brief Run the PPU up to the current CPU cycle
+   * \note The CPU only does this when the PPU can be observed (register access, OAM DMA, predicted
+   * PPU events), call it before reading PPU state from outside the emulation loop
+   */
+  void syncPPU();
+
+  /**
+   * \brief Get the scheduler that drives the CPU loop, components post their timed events here
+   */
+  Scheduler& getScheduler();
+
+  /**
+   * \brief Map count 256 byte pages of the CPU address space, starting at page firstPage, to data
+   * \param writable if false, writes to these pages are ignored (ROM)
+   * \note Mappers bank switch by calling this with a different part of prgRom
+   */
+  void mapPages(Byte firstPage, int count, Byte* data, bool writable);
+
+  /**
+   * \brief Record every executed instruction into trace, nullptr to stop tracing
+   * \note The CPU does not own the buffer, it must outlive the CPU or be detached first
+   */
+  void setTraceBuffer(TraceBuffer* trace);
+
+  /**
+   * \brief Count the host time of the CPU, the PPU and frame presentation into stats, nullptr to stop counting
+   * \note The CPU does not own the stats, they must outlive the CPU or be detached first
+   */
+  void setHostStats(HostStats* stats);
+
+#ifdef NES_PROFILER
+  [[nodiscard]] const ExecutionProfiler& getProfiler() const;
+  void resetProfiler();
+#endif
+
   uint64_t totalCycle;
+  uint64_t instructionCount; // Number of instructions executed since power up
+  uint64_t skippedCycles; // Cycles of totalCycle spent in idle loops that were fast-forwarded instead of executed
   std::vector<Byte> memory;
+  std::vector<Byte> prgRom;
 private:
   PPU& ppu;
   InputHandler& inputHandler;
+  Scheduler scheduler;
 
   static constexpr OpInfo opInfo[256] = {
     {1, 7}, {2, 6}, {0, 0}, {0, 0}, {0, 0}, {2, 3}, {2, 5}, {0, 0},  {1, 3}, {2, 2}, {1, 2}, {0, 0}, {0, 0}, {3, 4}, {3, 6}, {0, 0},
@@ -73,9 +133,137 @@ private:
 
   // Emulation
   int cycle;
+  bool isNMIHappening; // Set from the NMI being taken until the vblank flag clears
+  TraceBuffer* traceBuffer;
+  HostStats* hostStats;
+#ifdef NES_PROFILER
+  ExecutionProfiler profiler;
+#endif
+
+  void recordTrace(Byte opcode);
+
+  // Memory Map
+  /**
+   * \brief Read / write pointer of every 256 byte page of the CPU address space, indexed by addr >> 8
+   * \note nullptr pages are I/O ($2000 - $40FF) and go through readIO / writeIO, read only pages
+   * have a nullptr write pointer and also go through writeIO, which ignores them
+   */
+  std::array<Byte*, 256> readPages;
+  std::array<Byte*, 256> writePages;
+
+  void initPages();
+
+  /**
+   * \brief Start of the 256 byte page, falls back to the backing memory for I/O pages
+   */
+  [[nodiscard]] const Byte* getPage(Byte page) const;
+
+  // totalCycle at power up, the PPU clock starts counting from here
+  static constexpr uint64_t START_CYCLE = 7;
+
+  /**
+   * \brief PPU clock (3 PPU cycles per CPU cycle) matching the current totalCycle
+   */
+  [[nodiscard]] uint64_t getPPUClock() const;
+
+  /**
+   * \brief Handle the events that are due, called before an instruction once getNextEventTime() is reached
+   * \return true if an NMI was taken in place of the instruction
+   */
+  bool handleEvents();
 
   // Main Operation
-  bool executeOp(Byte op, Byte arg1, Byte arg2);
+  /**
+   * \brief Handler of a single opcode, returns false if the opcode already set programCounter
+   */
+  using OpHandler = bool (*)(CPU& cpu, Byte arg1, Byte arg2);
+
+  /**
+   * \brief Dispatch table indexed by opcode, generated from opInfo at compile time
+   * \note Every official opcode gets its own instantiation of executeOp, so the addressing mode and
+   * operation are resolved at compile time and inlined into one function per opcode
+   */
+  static const std::array<OpHandler, 256> opHandlers;
+
+  template <Byte op>
+  bool executeOp(Byte arg1, Byte arg2);
+
+  template <Byte op>
+  static bool dispatchOp(CPU& cpu, Byte arg1, Byte arg2);
+  static bool dispatchUnknownOp(CPU& cpu, Byte arg1, Byte arg2);
+
+  template <std::size_t... ops>
+  static constexpr std::array<OpHandler, 256> makeOpHandlers(std::index_sequence<ops...>);
+
+  template <std::size_t op>
+  static constexpr OpHandler selectOpHandler();
+
+  // Decoded Block Cache
+  /**
+   * \brief An instruction with its operands and handler already looked up
+   */
+  struct DecodedOp {
+    OpHandler handler;
+    Byte arg1;
+    Byte arg2;
+    Byte length;
+    Byte cycle;
+    Byte opcode;
+    Word pc;
+  };
+
+  static constexpr int MAX_BLOCK_LENGTH{ 16 };
+
+  /**
+   * \brief Straight line code starting at one PC, ending at the first instruction that sets programCounter
+   */
+  struct DecodedBlock {
+    int count;
+    bool isIdleLoop;
+    std::array<DecodedOp, MAX_BLOCK_LENGTH> ops;
+  };
+
+  static constexpr int32_t BLOCK_NOT_DECODED{ -1 };
+  static constexpr int32_t BLOCK_UNCACHEABLE{ -2 };
+
+  /**
+   * \brief Index into decodedBlocks of the block starting at each PC
+   * \note Only code in read only pages is cached, so the cache only has to be dropped when pages are remapped
+   */
+  std::vector<int32_t> blockLookup;
+  std::vector<DecodedBlock> decodedBlocks;
+  bool blocksInvalidated; // Set when the cache is dropped while a block may be executing
+
+  /**
+   * \brief Whether the next instruction needs nothing from executeNextClock() besides fetching and executing it,
+   * i.e. no event is due and tracing is off
+   */
+  [[nodiscard]] bool canRunDecoded() const;
+  [[nodiscard]] bool isNMIPending() const;
+  [[nodiscard]] bool isReadOnly(Word addr) const;
+
+  /**
+   * \brief Get the decoded block starting at pc, decoding it on first use
+   * \return nullptr if the code at pc cannot be cached
+   */
+  const DecodedBlock* findBlock(Word pc);
+  int32_t decodeBlock(Word pc);
+  void executeBlock(const DecodedBlock& block, uint64_t untilCycle);
+
+  /**
+   * \brief Whether the block at start loops straight back to start while only reading memory without side effects,
+   * so that once it has looped every iteration is the same until the next PPU event
+   * \note Allowed are LDA, LDX, LDY, CMP, CPX, CPY and BIT in immediate, zero page or absolute mode reading RAM or ROM,
+   * and LDA / BIT $2002 when the loop only tests the vblank flag with BPL / BMI
+   */
+  [[nodiscard]] bool isIdleLoop(Word start, int count) const;
+
+  /**
+   * \brief Execute one iteration of an idle loop block, then skip as many whole iterations as can be done
+   * without reaching untilCycle or the next PPU event
+   */
+  void executeIdleLoop(const DecodedBlock& block, uint64_t untilCycle);
+  void invalidateBlocks();
 
   // Addressing Mode
   Byte readImmediate(Byte arg1, Byte arg2);
@@ -102,32 +290,59 @@ private:
   // Helper
   Byte readMemory(Word addr);
   void writeMemory(Word addr, Byte input);
+  Byte readIO(Word addr);
+  void writeIO(Word addr, Byte input);
+  /**
+   * \brief Read memory without triggering any I/O side effect, used for opcode fetch and vectors
+   */
+  [[nodiscard]] Byte peekMemory(Word addr) const;
   [[nodiscard]] Byte convertFlag() const;
   void writeFlag(Byte input);
 
   // OP Handler
-  void handleLDA(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte));
-  void handleLDX(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte));
-  void handleLDY(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte));
-  void handleSTA(Byte arg1, Byte arg2, void (CPU::*writeFn)(Byte, Byte, Byte));
-  void handleSTX(Byte arg1, Byte arg2, void (CPU::*writeFn)(Byte, Byte, Byte));
-  void handleSTY(Byte arg1, Byte arg2, void (CPU::*writeFn)(Byte, Byte, Byte));
+  template <Byte (CPU::*readFn)(Byte, Byte)>
+  void handleLDA(Byte arg1, Byte arg2);
+  template <Byte (CPU::*readFn)(Byte, Byte)>
+  void handleLDX(Byte arg1, Byte arg2);
+  template <Byte (CPU::*readFn)(Byte, Byte)>
+  void handleLDY(Byte arg1, Byte arg2);
+  template <void (CPU::*writeFn)(Byte, Byte, Byte)>
+  void handleSTA(Byte arg1, Byte arg2);
+  template <void (CPU::*writeFn)(Byte, Byte, Byte)>
+  void handleSTX(Byte arg1, Byte arg2);
+  template <void (CPU::*writeFn)(Byte, Byte, Byte)>
+  void handleSTY(Byte arg1, Byte arg2);
   void handleBranch(Byte arg, bool flag);
-  void handleASL(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte));
-  void handleLSR(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte));
-  void handleROL(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte));
-  void handleROR(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte));
-  void handleINC(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte));
-  void handleDEC(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte));
-  void handleADC(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte));
-  void handleSBC(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte));
-  void handleCMP(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte));
-  void handleCPX(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte));
-  void handleCPY(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte));
-  void handleAND(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte));
-  void handleEOR(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte));
-  void handleORA(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte));
-  void handleBIT(Byte arg1, Byte arg2, Byte (CPU::*readFn)(Byte, Byte));
+  template <Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte)>
+  void handleASL(Byte arg1, Byte arg2);
+  template <Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte)>
+  void handleLSR(Byte arg1, Byte arg2);
+  template <Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte)>
+  void handleROL(Byte arg1, Byte arg2);
+  template <Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte)>
+  void handleROR(Byte arg1, Byte arg2);
+  template <Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte)>
+  void handleINC(Byte arg1, Byte arg2);
+  template <Byte (CPU::*readFn)(Byte, Byte), void (CPU::*writeFn)(Byte, Byte, Byte)>
+  void handleDEC(Byte arg1, Byte arg2);
+  template <Byte (CPU::*readFn)(Byte, Byte)>
+  void handleADC(Byte arg1, Byte arg2);
+  template <Byte (CPU::*readFn)(Byte, Byte)>
+  void handleSBC(Byte arg1, Byte arg2);
+  template <Byte (CPU::*readFn)(Byte, Byte)>
+  void handleCMP(Byte arg1, Byte arg2);
+  template <Byte (CPU::*readFn)(Byte, Byte)>
+  void handleCPX(Byte arg1, Byte arg2);
+  template <Byte (CPU::*readFn)(Byte, Byte)>
+  void handleCPY(Byte arg1, Byte arg2);
+  template <Byte (CPU::*readFn)(Byte, Byte)>
+  void handleAND(Byte arg1, Byte arg2);
+  template <Byte (CPU::*readFn)(Byte, Byte)>
+  void handleEOR(Byte arg1, Byte arg2);
+  template <Byte (CPU::*readFn)(Byte, Byte)>
+  void handleORA(Byte arg1, Byte arg2);
+  template <Byte (CPU::*readFn)(Byte, Byte)>
+  void handleBIT(Byte arg1, Byte arg2);
 };
 
 #endif
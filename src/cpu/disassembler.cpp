@@ -0,0 +1,163 @@
+#include "disassembler.h"
+#include <array>
+#include <cstdio>
+
+static constexpr std::array<OpDescription, 256> opDescriptions{{
+  {"BRK", AddressingMode::IMPLIED}, {"ORA", AddressingMode::INDEXED_INDIRECT}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"ORA", AddressingMode::ZERO_PAGE}, {"ASL", AddressingMode::ZERO_PAGE}, {nullptr, AddressingMode::IMPLIED},
+  {"PHP", AddressingMode::IMPLIED}, {"ORA", AddressingMode::IMMEDIATE}, {"ASL", AddressingMode::ACCUMULATOR}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"ORA", AddressingMode::ABSOLUTE}, {"ASL", AddressingMode::ABSOLUTE}, {nullptr, AddressingMode::IMPLIED},
+
+  {"BPL", AddressingMode::RELATIVE}, {"ORA", AddressingMode::INDIRECT_INDEXED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"ORA", AddressingMode::ZERO_PAGE_X}, {"ASL", AddressingMode::ZERO_PAGE_X}, {nullptr, AddressingMode::IMPLIED},
+  {"CLC", AddressingMode::IMPLIED}, {"ORA", AddressingMode::ABSOLUTE_Y}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"ORA", AddressingMode::ABSOLUTE_X}, {"ASL", AddressingMode::ABSOLUTE_X}, {nullptr, AddressingMode::IMPLIED},
+
+  {"JSR", AddressingMode::ABSOLUTE}, {"AND", AddressingMode::INDEXED_INDIRECT}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"BIT", AddressingMode::ZERO_PAGE}, {"AND", AddressingMode::ZERO_PAGE}, {"ROL", AddressingMode::ZERO_PAGE}, {nullptr, AddressingMode::IMPLIED},
+  {"PLP", AddressingMode::IMPLIED}, {"AND", AddressingMode::IMMEDIATE}, {"ROL", AddressingMode::ACCUMULATOR}, {nullptr, AddressingMode::IMPLIED}, {"BIT", AddressingMode::ABSOLUTE}, {"AND", AddressingMode::ABSOLUTE}, {"ROL", AddressingMode::ABSOLUTE}, {nullptr, AddressingMode::IMPLIED},
+
+  {"BMI", AddressingMode::RELATIVE}, {"AND", AddressingMode::INDIRECT_INDEXED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"AND", AddressingMode::ZERO_PAGE_X}, {"ROL", AddressingMode::ZERO_PAGE_X}, {nullptr, AddressingMode::IMPLIED},
+  {"SEC", AddressingMode::IMPLIED}, {"AND", AddressingMode::ABSOLUTE_Y}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"AND", AddressingMode::ABSOLUTE_X}, {"ROL", AddressingMode::ABSOLUTE_X}, {nullptr, AddressingMode::IMPLIED},
+
+  {"RTI", AddressingMode::IMPLIED}, {"EOR", AddressingMode::INDEXED_INDIRECT}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"EOR", AddressingMode::ZERO_PAGE}, {"LSR", AddressingMode::ZERO_PAGE}, {nullptr, AddressingMode::IMPLIED},
+  {"PHA", AddressingMode::IMPLIED}, {"EOR", AddressingMode::IMMEDIATE}, {"LSR", AddressingMode::ACCUMULATOR}, {nullptr, AddressingMode::IMPLIED}, {"JMP", AddressingMode::ABSOLUTE}, {"EOR", AddressingMode::ABSOLUTE}, {"LSR", AddressingMode::ABSOLUTE}, {nullptr, AddressingMode::IMPLIED},
+
+  {"BVC", AddressingMode::RELATIVE}, {"EOR", AddressingMode::INDIRECT_INDEXED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"EOR", AddressingMode::ZERO_PAGE_X}, {"LSR", AddressingMode::ZERO_PAGE_X}, {nullptr, AddressingMode::IMPLIED},
+  {"CLI", AddressingMode::IMPLIED}, {"EOR", AddressingMode::ABSOLUTE_Y}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"EOR", AddressingMode::ABSOLUTE_X}, {"LSR", AddressingMode::ABSOLUTE_X}, {nullptr, AddressingMode::IMPLIED},
+
+  {"RTS", AddressingMode::IMPLIED}, {"ADC", AddressingMode::INDEXED_INDIRECT}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"ADC", AddressingMode::ZERO_PAGE}, {"ROR", AddressingMode::ZERO_PAGE}, {nullptr, AddressingMode::IMPLIED},
+  {"PLA", AddressingMode::IMPLIED}, {"ADC", AddressingMode::IMMEDIATE}, {"ROR", AddressingMode::ACCUMULATOR}, {nullptr, AddressingMode::IMPLIED}, {"JMP", AddressingMode::INDIRECT}, {"ADC", AddressingMode::ABSOLUTE}, {"ROR", AddressingMode::ABSOLUTE}, {nullptr, AddressingMode::IMPLIED},
+
+  {"BVS", AddressingMode::RELATIVE}, {"ADC", AddressingMode::INDIRECT_INDEXED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"ADC", AddressingMode::ZERO_PAGE_X}, {"ROR", AddressingMode::ZERO_PAGE_X}, {nullptr, AddressingMode::IMPLIED},
+  {"SEI", AddressingMode::IMPLIED}, {"ADC", AddressingMode::ABSOLUTE_Y}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"ADC", AddressingMode::ABSOLUTE_X}, {"ROR", AddressingMode::ABSOLUTE_X}, {nullptr, AddressingMode::IMPLIED},
+
+  {nullptr, AddressingMode::IMPLIED}, {"STA", AddressingMode::INDEXED_INDIRECT}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"STY", AddressingMode::ZERO_PAGE}, {"STA", AddressingMode::ZERO_PAGE}, {"STX", AddressingMode::ZERO_PAGE}, {nullptr, AddressingMode::IMPLIED},
+  {"DEY", AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"TXA", AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"STY", AddressingMode::ABSOLUTE}, {"STA", AddressingMode::ABSOLUTE}, {"STX", AddressingMode::ABSOLUTE}, {nullptr, AddressingMode::IMPLIED},
+
+  {"BCC", AddressingMode::RELATIVE}, {"STA", AddressingMode::INDIRECT_INDEXED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"STY", AddressingMode::ZERO_PAGE_X}, {"STA", AddressingMode::ZERO_PAGE_X}, {"STX", AddressingMode::ZERO_PAGE_Y}, {nullptr, AddressingMode::IMPLIED},
+  {"TYA", AddressingMode::IMPLIED}, {"STA", AddressingMode::ABSOLUTE_Y}, {"TXS", AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"STA", AddressingMode::ABSOLUTE_X}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED},
+
+  {"LDY", AddressingMode::IMMEDIATE}, {"LDA", AddressingMode::INDEXED_INDIRECT}, {"LDX", AddressingMode::IMMEDIATE}, {nullptr, AddressingMode::IMPLIED}, {"LDY", AddressingMode::ZERO_PAGE}, {"LDA", AddressingMode::ZERO_PAGE}, {"LDX", AddressingMode::ZERO_PAGE}, {nullptr, AddressingMode::IMPLIED},
+  {"TAY", AddressingMode::IMPLIED}, {"LDA", AddressingMode::IMMEDIATE}, {"TAX", AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"LDY", AddressingMode::ABSOLUTE}, {"LDA", AddressingMode::ABSOLUTE}, {"LDX", AddressingMode::ABSOLUTE}, {nullptr, AddressingMode::IMPLIED},
+
+  {"BCS", AddressingMode::RELATIVE}, {"LDA", AddressingMode::INDIRECT_INDEXED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"LDY", AddressingMode::ZERO_PAGE_X}, {"LDA", AddressingMode::ZERO_PAGE_X}, {"LDX", AddressingMode::ZERO_PAGE_Y}, {nullptr, AddressingMode::IMPLIED},
+  {"CLV", AddressingMode::IMPLIED}, {"LDA", AddressingMode::ABSOLUTE_Y}, {"TSX", AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"LDY", AddressingMode::ABSOLUTE_X}, {"LDA", AddressingMode::ABSOLUTE_X}, {"LDX", AddressingMode::ABSOLUTE_Y}, {nullptr, AddressingMode::IMPLIED},
+
+  {"CPY", AddressingMode::IMMEDIATE}, {"CMP", AddressingMode::INDEXED_INDIRECT}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"CPY", AddressingMode::ZERO_PAGE}, {"CMP", AddressingMode::ZERO_PAGE}, {"DEC", AddressingMode::ZERO_PAGE}, {nullptr, AddressingMode::IMPLIED},
+  {"INY", AddressingMode::IMPLIED}, {"CMP", AddressingMode::IMMEDIATE}, {"DEX", AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"CPY", AddressingMode::ABSOLUTE}, {"CMP", AddressingMode::ABSOLUTE}, {"DEC", AddressingMode::ABSOLUTE}, {nullptr, AddressingMode::IMPLIED},
+
+  {"BNE", AddressingMode::RELATIVE}, {"CMP", AddressingMode::INDIRECT_INDEXED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"CMP", AddressingMode::ZERO_PAGE_X}, {"DEC", AddressingMode::ZERO_PAGE_X}, {nullptr, AddressingMode::IMPLIED},
+  {"CLD", AddressingMode::IMPLIED}, {"CMP", AddressingMode::ABSOLUTE_Y}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"CMP", AddressingMode::ABSOLUTE_X}, {"DEC", AddressingMode::ABSOLUTE_X}, {nullptr, AddressingMode::IMPLIED},
+
+  {"CPX", AddressingMode::IMMEDIATE}, {"SBC", AddressingMode::INDEXED_INDIRECT}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"CPX", AddressingMode::ZERO_PAGE}, {"SBC", AddressingMode::ZERO_PAGE}, {"INC", AddressingMode::ZERO_PAGE}, {nullptr, AddressingMode::IMPLIED},
+  {"INX", AddressingMode::IMPLIED}, {"SBC", AddressingMode::IMMEDIATE}, {"NOP", AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"CPX", AddressingMode::ABSOLUTE}, {"SBC", AddressingMode::ABSOLUTE}, {"INC", AddressingMode::ABSOLUTE}, {nullptr, AddressingMode::IMPLIED},
+
+  {"BEQ", AddressingMode::RELATIVE}, {"SBC", AddressingMode::INDIRECT_INDEXED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"SBC", AddressingMode::ZERO_PAGE_X}, {"INC", AddressingMode::ZERO_PAGE_X}, {nullptr, AddressingMode::IMPLIED},
+  {"SED", AddressingMode::IMPLIED}, {"SBC", AddressingMode::ABSOLUTE_Y}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {nullptr, AddressingMode::IMPLIED}, {"SBC", AddressingMode::ABSOLUTE_X}, {"INC", AddressingMode::ABSOLUTE_X}, {nullptr, AddressingMode::IMPLIED},
+}};
+
+const OpDescription& describeOp(Byte opcode) {
+  return opDescriptions[opcode];
+}
+
+const char* getAddressingModeName(AddressingMode mode) {
+  switch (mode) {
+    case AddressingMode::IMPLIED:
+      return "IMPLIED";
+    case AddressingMode::ACCUMULATOR:
+      return "ACCUMULATOR";
+    case AddressingMode::IMMEDIATE:
+      return "IMMEDIATE";
+    case AddressingMode::ZERO_PAGE:
+      return "ZERO_PAGE";
+    case AddressingMode::ZERO_PAGE_X:
+      return "ZERO_PAGE_X";
+    case AddressingMode::ZERO_PAGE_Y:
+      return "ZERO_PAGE_Y";
+    case AddressingMode::RELATIVE:
+      return "RELATIVE";
+    case AddressingMode::ABSOLUTE:
+      return "ABSOLUTE";
+    case AddressingMode::ABSOLUTE_X:
+      return "ABSOLUTE_X";
+    case AddressingMode::ABSOLUTE_Y:
+      return "ABSOLUTE_Y";
+    case AddressingMode::INDIRECT:
+      return "INDIRECT";
+    case AddressingMode::INDEXED_INDIRECT:
+      return "INDEXED_INDIRECT";
+    case AddressingMode::INDIRECT_INDEXED:
+      return "INDIRECT_INDEXED";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+int getInstructionLength(Byte opcode) {
+  const OpDescription& op{ opDescriptions[opcode] };
+  if (!op.mnemonic)
+    return 1;
+
+  switch (op.mode) {
+    case AddressingMode::IMPLIED:
+    case AddressingMode::ACCUMULATOR:
+      return 1;
+    case AddressingMode::ABSOLUTE:
+    case AddressingMode::ABSOLUTE_X:
+    case AddressingMode::ABSOLUTE_Y:
+    case AddressingMode::INDIRECT:
+      return 3;
+    default:
+      return 2;
+  }
+}
+
+std::string disassemble(Word pc, Byte opcode, Byte arg1, Byte arg2) {
+  const OpDescription& op{ opDescriptions[opcode] };
+  if (!op.mnemonic)
+    return "???";
+
+  const Word absolute{ static_cast<Word>(arg1 + (arg2 << 8)) };
+  char text[16];
+  switch (op.mode) {
+    case AddressingMode::IMPLIED:
+      snprintf(text, sizeof(text), "%s", op.mnemonic);
+      break;
+    case AddressingMode::ACCUMULATOR:
+      snprintf(text, sizeof(text), "%s A", op.mnemonic);
+      break;
+    case AddressingMode::IMMEDIATE:
+      snprintf(text, sizeof(text), "%s #$%02X", op.mnemonic, arg1);
+      break;
+    case AddressingMode::ZERO_PAGE:
+      snprintf(text, sizeof(text), "%s $%02X", op.mnemonic, arg1);
+      break;
+    case AddressingMode::ZERO_PAGE_X:
+      snprintf(text, sizeof(text), "%s $%02X,X", op.mnemonic, arg1);
+      break;
+    case AddressingMode::ZERO_PAGE_Y:
+      snprintf(text, sizeof(text), "%s $%02X,Y", op.mnemonic, arg1);
+      break;
+    case AddressingMode::RELATIVE:
+      snprintf(text, sizeof(text), "%s $%04X", op.mnemonic, static_cast<Word>(pc + 2 + static_cast<int8_t>(arg1)));
+      break;
+    case AddressingMode::ABSOLUTE:
+      snprintf(text, sizeof(text), "%s $%04X", op.mnemonic, absolute);
+      break;
+    case AddressingMode::ABSOLUTE_X:
+      snprintf(text, sizeof(text), "%s $%04X,X", op.mnemonic, absolute);
+      break;
+    case AddressingMode::ABSOLUTE_Y:
+      snprintf(text, sizeof(text), "%s $%04X,Y", op.mnemonic, absolute);
+      break;
+    case AddressingMode::INDIRECT:
+      snprintf(text, sizeof(text), "%s ($%04X)", op.mnemonic, absolute);
+      break;
+    case AddressingMode::INDEXED_INDIRECT:
+      snprintf(text, sizeof(text), "%s ($%02X,X)", op.mnemonic, arg1);
+      break;
+    case AddressingMode::INDIRECT_INDEXED:
+      snprintf(text, sizeof(text), "%s ($%02X),Y", op.mnemonic, arg1);
+      break;
+    default:
+      snprintf(text, sizeof(text), "%s", op.mnemonic);
+      break;
+  }
+  return text;
+}
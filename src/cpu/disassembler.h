@@ -0,0 +1,51 @@
+#ifndef NESEMULATOR_DISASSEMBLER_H
+#define NESEMULATOR_DISASSEMBLER_H
+
+#include "../constants.h"
+#include <string>
+
+enum class AddressingMode {
+  IMPLIED,
+  ACCUMULATOR,
+  IMMEDIATE,
+  ZERO_PAGE,
+  ZERO_PAGE_X,
+  ZERO_PAGE_Y,
+  RELATIVE,
+  ABSOLUTE,
+  ABSOLUTE_X,
+  ABSOLUTE_Y,
+  INDIRECT,
+  INDEXED_INDIRECT,
+  INDIRECT_INDEXED,
+  COUNT
+};
+
+struct OpDescription {
+  const char* mnemonic; // nullptr for opcodes the CPU does not implement
+  AddressingMode mode;
+};
+
+/**
+ * \brief Get the mnemonic and addressing mode of an opcode
+ */
+const OpDescription& describeOp(Byte opcode);
+
+/**
+ * \brief Get the name of an addressing mode, e.g. "ZERO_PAGE_X"
+ */
+const char* getAddressingModeName(AddressingMode mode);
+
+/**
+ * \brief Get the number of bytes of an instruction, unknown opcodes count as 1
+ */
+int getInstructionLength(Byte opcode);
+
+/**
+ * \brief Disassemble a single instruction in the syntax used by nestest.log, e.g. "LDA ($80),Y" or "BNE $C72A"
+ * \param pc address of the opcode, used to resolve branch targets
+ * \note Unknown opcodes disassemble to "???"
+ */
+std::string disassemble(Word pc, Byte opcode, Byte arg1, Byte arg2);
+
+#endif
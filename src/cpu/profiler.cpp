@@ -0,0 +1,155 @@
+#include "profiler.h"
+#include "disassembler.h"
+#include <algorithm>
+#include <numeric>
+#include <cstdio>
+
+ExecutionProfiler::ExecutionProfiler() : opcodeCounts{}, opcodeCycles{},
+pcCounts(0x10000), pcCycles(0x10000), pcOpcodes(0x10000), nmiCount{}, nmiCycles{} {}
+
+void ExecutionProfiler::record(Word pc, Byte opcode, uint64_t cycles) {
+  opcodeCounts[opcode]++;
+  opcodeCycles[opcode] += cycles;
+  pcCounts[pc]++;
+  pcCycles[pc] += cycles;
+  pcOpcodes[pc] = opcode;
+}
+
+void ExecutionProfiler::recordRepeated(Word pc, Byte opcode, uint64_t times, uint64_t cycles) {
+  opcodeCounts[opcode] += times;
+  opcodeCycles[opcode] += cycles;
+  pcCounts[pc] += times;
+  pcCycles[pc] += cycles;
+  pcOpcodes[pc] = opcode;
+}
+
+void ExecutionProfiler::recordNMI(uint64_t cycles) {
+  nmiCount++;
+  nmiCycles += cycles;
+}
+
+void ExecutionProfiler::reset() {
+  opcodeCounts.fill(0);
+  opcodeCycles.fill(0);
+  std::fill(pcCounts.begin(), pcCounts.end(), 0);
+  std::fill(pcCycles.begin(), pcCycles.end(), 0);
+  std::fill(pcOpcodes.begin(), pcOpcodes.end(), 0);
+  nmiCount = 0;
+  nmiCycles = 0;
+}
+
+uint64_t ExecutionProfiler::getTotalCount() const {
+  return std::accumulate(opcodeCounts.begin(), opcodeCounts.end(), uint64_t{});
+}
+
+uint64_t ExecutionProfiler::getTotalCycles() const {
+  return std::accumulate(opcodeCycles.begin(), opcodeCycles.end(), uint64_t{}) + nmiCycles;
+}
+
+uint64_t ExecutionProfiler::getNMICount() const {
+  return nmiCount;
+}
+
+uint64_t ExecutionProfiler::getNMICycles() const {
+  return nmiCycles;
+}
+
+static const char* getMnemonic(Byte opcode) {
+  const char* mnemonic{ describeOp(opcode).mnemonic };
+  return mnemonic ? mnemonic : "???";
+}
+
+void ExecutionProfiler::exportCSV(std::ostream& out) const {
+  char line[96];
+  out << "section,key,instruction,count,cycles\n";
+
+  for (int opcode{}; opcode < 256; opcode++) {
+    if (opcodeCounts[opcode] == 0)
+      continue;
+    snprintf(line, sizeof(line), "opcode,$%02X,%s %s,%llu,%llu\n", opcode, getMnemonic(opcode),
+             getAddressingModeName(describeOp(opcode).mode),
+             static_cast<unsigned long long>(opcodeCounts[opcode]), static_cast<unsigned long long>(opcodeCycles[opcode]));
+    out << line;
+  }
+
+  std::array<uint64_t, static_cast<int>(AddressingMode::COUNT)> modeCounts{};
+  std::array<uint64_t, static_cast<int>(AddressingMode::COUNT)> modeCycles{};
+  for (int opcode{}; opcode < 256; opcode++) {
+    modeCounts[static_cast<int>(describeOp(opcode).mode)] += opcodeCounts[opcode];
+    modeCycles[static_cast<int>(describeOp(opcode).mode)] += opcodeCycles[opcode];
+  }
+  for (int mode{}; mode < static_cast<int>(AddressingMode::COUNT); mode++) {
+    if (modeCounts[mode] == 0)
+      continue;
+    snprintf(line, sizeof(line), "mode,%s,,%llu,%llu\n", getAddressingModeName(static_cast<AddressingMode>(mode)),
+             static_cast<unsigned long long>(modeCounts[mode]), static_cast<unsigned long long>(modeCycles[mode]));
+    out << line;
+  }
+
+  for (int pc{}; pc < 0x10000; pc++) {
+    if (pcCounts[pc] == 0)
+      continue;
+    snprintf(line, sizeof(line), "pc,$%04X,%s,%llu,%llu\n", pc, getMnemonic(pcOpcodes[pc]),
+             static_cast<unsigned long long>(pcCounts[pc]), static_cast<unsigned long long>(pcCycles[pc]));
+    out << line;
+  }
+
+  if (nmiCount > 0) {
+    snprintf(line, sizeof(line), "interrupt,NMI,,%llu,%llu\n", static_cast<unsigned long long>(nmiCount),
+             static_cast<unsigned long long>(nmiCycles));
+    out << line;
+  }
+}
+
+void ExecutionProfiler::printReport(std::ostream& out, int topN) const {
+  const uint64_t totalCycles{ std::max<uint64_t>(getTotalCycles(), 1) };
+  char line[96];
+
+  // Rank the indices of counts by their cycles and print the first topN
+  auto printTop = [&](const char* title, int size, auto getCycles, auto getCount, auto getName) {
+    std::vector<int> order(size);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return getCycles(a) > getCycles(b); });
+
+    out << title << "\n";
+    for (int i{}; i < std::min(topN, size) && getCycles(order[i]) > 0; i++) {
+      snprintf(line, sizeof(line), "  %-24s %12llu runs %14llu cycles %6.2f%%\n", getName(order[i]).c_str(),
+               static_cast<unsigned long long>(getCount(order[i])), static_cast<unsigned long long>(getCycles(order[i])),
+               100.0 * getCycles(order[i]) / totalCycles);
+      out << line;
+    }
+  };
+
+  printTop("Opcodes", 256,
+    [&](int opcode) { return opcodeCycles[opcode]; },
+    [&](int opcode) { return opcodeCounts[opcode]; },
+    [&](int opcode) {
+      return std::string{"$"} + "0123456789ABCDEF"[opcode >> 4] + "0123456789ABCDEF"[opcode & 0xF] + " " +
+             getMnemonic(opcode) + " " + getAddressingModeName(describeOp(opcode).mode);
+    });
+
+  std::array<uint64_t, static_cast<int>(AddressingMode::COUNT)> modeCounts{};
+  std::array<uint64_t, static_cast<int>(AddressingMode::COUNT)> modeCycles{};
+  for (int opcode{}; opcode < 256; opcode++) {
+    modeCounts[static_cast<int>(describeOp(opcode).mode)] += opcodeCounts[opcode];
+    modeCycles[static_cast<int>(describeOp(opcode).mode)] += opcodeCycles[opcode];
+  }
+  printTop("Addressing modes", static_cast<int>(AddressingMode::COUNT),
+    [&](int mode) { return modeCycles[mode]; },
+    [&](int mode) { return modeCounts[mode]; },
+    [&](int mode) { return std::string{ getAddressingModeName(static_cast<AddressingMode>(mode)) }; });
+
+  printTop("PCs", 0x10000,
+    [&](int pc) { return pcCycles[pc]; },
+    [&](int pc) { return pcCounts[pc]; },
+    [&](int pc) {
+      char name[16];
+      snprintf(name, sizeof(name), "$%04X %s", pc, getMnemonic(pcOpcodes[pc]));
+      return std::string{ name };
+    });
+
+  printTop("Interrupts", 1,
+    [&](int) { return nmiCycles; },
+    [&](int) { return nmiCount; },
+    [&](int) { return std::string{"NMI"}; });
+}
@@ -0,0 +1,72 @@
+#ifndef NESEMULATOR_PROFILER_H
+#define NESEMULATOR_PROFILER_H
+
+#include "../constants.h"
+#include <array>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+
+/**
+ * \brief Execution count and cycles of the emulated program per opcode, per addressing mode and per PC
+ * \note The CPU only feeds this when built with NES_PROFILER, otherwise none of it is compiled into the hot path.
+ * The 7 cycles of entering an NMI are counted separately from the instructions, so getTotalCycles() adds up to the
+ * cycles the CPU executed
+ */
+class ExecutionProfiler {
+public:
+  ExecutionProfiler();
+
+  /**
+   * \brief Count one execution of the instruction at pc
+   * \param cycles cycles the instruction took, including page crossing, branch and DMA cycles
+   */
+  void record(Word pc, Byte opcode, uint64_t cycles);
+
+  /**
+   * \brief Count times executions of the instruction at pc taking cycles in total, used for fast-forwarded loops
+   */
+  void recordRepeated(Word pc, Byte opcode, uint64_t times, uint64_t cycles);
+
+  /**
+   * \brief Count one NMI taken, cycles being the cycles of pushing the state and jumping to the vector
+   */
+  void recordNMI(uint64_t cycles);
+
+  void reset();
+
+  /**
+   * \brief Get the number of instructions executed, NMIs are not instructions and not part of it
+   */
+  [[nodiscard]] uint64_t getTotalCount() const;
+
+  /**
+   * \brief Get the cycles of every instruction and NMI
+   */
+  [[nodiscard]] uint64_t getTotalCycles() const;
+
+  [[nodiscard]] uint64_t getNMICount() const;
+  [[nodiscard]] uint64_t getNMICycles() const;
+
+  /**
+   * \brief Write one row per opcode, addressing mode and PC that executed at least once
+   * \note Columns are section,key,instruction,count,cycles where section is opcode, mode, pc or interrupt
+   */
+  void exportCSV(std::ostream& out) const;
+
+  /**
+   * \brief Write the topN opcodes, addressing modes and PCs ranked by cycles with their share of the total
+   */
+  void printReport(std::ostream& out, int topN) const;
+
+private:
+  std::array<uint64_t, 256> opcodeCounts;
+  std::array<uint64_t, 256> opcodeCycles;
+  std::vector<uint64_t> pcCounts;
+  std::vector<uint64_t> pcCycles;
+  std::vector<Byte> pcOpcodes; // Opcode last executed at each PC
+  uint64_t nmiCount;
+  uint64_t nmiCycles;
+};
+
+#endif
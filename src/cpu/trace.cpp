@@ -0,0 +1,64 @@
+#include "trace.h"
+#include "disassembler.h"
+#include <cstdio>
+
+static std::size_t roundUpToPowerOf2(std::size_t value) {
+  std::size_t result{ 1 };
+  while (result < value)
+    result <<= 1;
+  return result;
+}
+
+TraceBuffer::TraceBuffer(std::size_t capacity) : records(roundUpToPowerOf2(capacity)),
+mask{records.size() - 1}, recorded{} {}
+
+void TraceBuffer::record(const TraceRecord& record) {
+  records[recorded & mask] = record;
+  recorded++;
+}
+
+void TraceBuffer::clear() {
+  recorded = 0;
+}
+
+std::size_t TraceBuffer::size() const {
+  return recorded < records.size() ? recorded : records.size();
+}
+
+std::size_t TraceBuffer::getCapacity() const {
+  return records.size();
+}
+
+const TraceRecord& TraceBuffer::operator[](std::size_t index) const {
+  return records[(recorded - size() + index) & mask];
+}
+
+void exportNestestLog(const TraceBuffer& trace, std::ostream& out, Word firstPC, Word lastPC) {
+  for (std::size_t i{}; i < trace.size(); i++) {
+    const TraceRecord& record{ trace[i] };
+    if (record.pc < firstPC || lastPC < record.pc)
+      continue;
+
+    const int length{ getInstructionLength(record.opcode) };
+
+    char bytes[9];
+    switch (length) {
+      case 1:
+        snprintf(bytes, sizeof(bytes), "%02X", record.opcode);
+        break;
+      case 2:
+        snprintf(bytes, sizeof(bytes), "%02X %02X", record.opcode, record.arg1);
+        break;
+      default:
+        snprintf(bytes, sizeof(bytes), "%02X %02X %02X", record.opcode, record.arg1, record.arg2);
+        break;
+    }
+
+    char line[128];
+    snprintf(line, sizeof(line), "%04X  %-8s  %-32sA:%02X X:%02X Y:%02X P:%02X SP:%02X PPU:%3d,%3d CYC:%llu\n",
+             record.pc, bytes, disassemble(record.pc, record.opcode, record.arg1, record.arg2).c_str(),
+             record.accumulator, record.x, record.y, record.flags, record.stackPointer,
+             record.ppuScanline, record.ppuCycle, static_cast<unsigned long long>(record.cycle));
+    out << line;
+  }
+}
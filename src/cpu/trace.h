@@ -0,0 +1,66 @@
+#ifndef NESEMULATOR_TRACE_H
+#define NESEMULATOR_TRACE_H
+
+#include "../constants.h"
+#include <vector>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * \brief CPU state right before an instruction executes, as nestest.log shows it
+ */
+struct TraceRecord {
+  uint64_t cycle;
+  Word pc;
+  Byte opcode;
+  Byte arg1;
+  Byte arg2;
+  Byte accumulator;
+  Byte x;
+  Byte y;
+  Byte flags;
+  Byte stackPointer;
+  int16_t ppuScanline;
+  int16_t ppuCycle;
+};
+
+/**
+ * \brief Fixed size ring buffer of the last executed instructions
+ * \note Recording only copies the record, formatting is left to exportNestestLog() so tracing can stay enabled
+ */
+class TraceBuffer {
+public:
+  /**
+   * \param capacity number of records kept, rounded up to a power of 2
+   */
+  explicit TraceBuffer(std::size_t capacity);
+
+  void record(const TraceRecord& record);
+  void clear();
+
+  /**
+   * \brief Get the number of records currently held, at most getCapacity()
+   */
+  [[nodiscard]] std::size_t size() const;
+  [[nodiscard]] std::size_t getCapacity() const;
+
+  /**
+   * \brief Get a record, 0 is the oldest record still held
+   */
+  [[nodiscard]] const TraceRecord& operator[](std::size_t index) const;
+
+private:
+  std::vector<TraceRecord> records;
+  std::size_t mask;
+  uint64_t recorded; // Total number of records since the last clear, the next write goes to recorded & mask
+};
+
+/**
+ * \brief Write the held records oldest first in the nestest.log format
+ * \param firstPC only records with firstPC <= PC <= lastPC are written
+ * \note The memory values nestest.log appends to operands ("= 00") are not recorded and so not written
+ */
+void exportNestestLog(const TraceBuffer& trace, std::ostream& out, Word firstPC = 0x0000, Word lastPC = 0xFFFF);
+
+#endif
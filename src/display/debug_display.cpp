@@ -116,16 +116,11 @@ uint32_t* DebugDisplay::drawPatternTable(int patternTableIndex) {
     int drawY{ y * 8 };
     for (int x{}; x < 16; x++) {
       int drawX{ x * 8 };
-      int ptrnLocation{ startingIndex + (y * 16 + x) * 16 };
+      int tile{ (startingIndex >> 4) + y * 16 + x };
       for (int patternY{}; patternY < 8; patternY++) {
-        uint8_t low{ ppu.readMemory(ptrnLocation + patternY) };
-        uint8_t high{ ppu.readMemory(ptrnLocation + 8 + patternY) };
-        for (int patternX{}; patternX < 8; patternX++) {
-          int pixelValue{ ((low & 0x80) >> 7) + ((high & 0x80) >> 7) * 2 };
-          res[(drawY + patternY) * 128 + (drawX + patternX)] = translatePixelValue(pixelValue);
-          low <<= 1;
-          high <<= 1;
-        }
+        const Byte* pixels{ ppu.tileCache.getRow(tile, patternY, false) };
+        for (int patternX{}; patternX < 8; patternX++)
+          res[(drawY + patternY) * 128 + (drawX + patternX)] = translatePixelValue(pixels[patternX]);
       }
     }
   }
@@ -175,10 +170,8 @@ void DebugDisplay::updateNameTable() {
 
   // NameTable Title
   std::string nameTableTitle{ "NameTable: " };
-  if (ppu.nametableArrangement)
-    nameTableTitle += "Horizontal Arrangement";
-  else
-    nameTableTitle += "Vertical Arrangement";
+  nameTableTitle += getMirroringName(ppu.getMirroring());
+  nameTableTitle += " Mirroring";
   nameTableTitle += " TL: 0x2000, TR: 0x2400, BL: 0x2800, BR: 0x2C00";
   TextTexture nameTableTitleTexture = renderText(nameTableTitle);
 
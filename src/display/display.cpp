@@ -1,83 +1,73 @@
 #include "SDL.h"
 #include "display.h"
+#include "palette.h"
 #include "../constants.h"
-#include <vector>
+#include <cstdio>
 
-Display::~Display() {
-  delete[] buffer;
-}
-
-Display::Display(SDL_Renderer *renderer, SDL_Texture* texture) : renderer{renderer}, texture{texture}, screenRect{} {
-  buffer = new uint32_t[EmuConst::SCREEN_WIDTH * EmuConst::SCREEN_HEIGHT];
+Display::Display(SDL_Renderer *renderer, SDL_Texture* texture) : renderer{renderer}, texture{texture}, screenRect{},
+isLockable{}, isLocked{}, pixels{}, pitch{}, buffers{}, backBuffer{} {
   screenRect.x = 0;
   screenRect.y = 0;
   screenRect.w = EmuConst::SCALED_SCREEN_WIDTH;
   screenRect.h = EmuConst::SCALED_SCREEN_HEIGHT;
+
+  // Locking saves the copy of SDL_UpdateTexture where the texture lives in video memory, the software renderer
+  // keeps its textures in system memory anyway
+  SDL_RendererInfo info{};
+  isLockable = SDL_GetRendererInfo(renderer, &info) == 0 && (info.flags & SDL_RENDERER_SOFTWARE) == 0;
+  beginFrame();
 }
 
 void Display::drawPixel(int x, int y, Byte colorIndex, Byte ppuMask) {
-  if (ppuMask & 0b1110'0000) {
-    uint32_t color{ EmuConst::colors[colorIndex] };
-    Byte red = (color & 0xFF0000) >> 16;
-    Byte green = (color & 0xFF00) >> 8;
-    Byte blue = color & 0xFF;
-
-    bool emphasiseRed{};
-    bool emphasiseGreen{};
-    bool emphasiseBlue{};
-
-    if (ppuMask & 0b0010'0000)
-      emphasiseRed = true;
-
-    if (ppuMask & 0b0100'0000)
-      emphasiseGreen = true;
-
-    if (ppuMask & 0b1000'0000)
-      emphasiseBlue = true;
-
-    float baseReduce{ 2.0 / 3.0 };
+  pixels[y * pitch + x] = palette.convert(colorIndex, ppuMask);
+}
 
-    // Ignore warnings here
-    if (emphasiseRed && emphasiseGreen && emphasiseBlue) {
-      red *= baseReduce;
-      green *= baseReduce;
-      blue *= baseReduce;
-    } else if (emphasiseRed && emphasiseGreen) {
-      red *= 0.75;
-      green *= 0.75;
-      blue *= 0.40;
-    } else if (emphasiseGreen && emphasiseBlue) {
-      red *= 0.40;
-      green *= 0.75;
-      blue *= 0.75;
-    } else if (emphasiseRed && emphasiseBlue) {
-      red *= 0.75;
-      green *= 0.40;
-      blue *= 0.75;
-    } else if (emphasiseRed) {
-      green *= baseReduce;
-      blue *= baseReduce;
-    } else if (emphasiseGreen) {
-      red *= baseReduce;
-      blue *= baseReduce;
-    } else {
-      red *= baseReduce;
-      green *= baseReduce;
-    }
+void Display::drawScanline(int y, const Byte* colorIndices, Byte ppuMask) {
+  convertLine(colorIndices, palette.getTable(ppuMask), &pixels[y * pitch]);
+}
 
-    buffer[y * EmuConst::SCREEN_WIDTH + x] = (red << 16) | (green << 8) | blue | 0xFF00'0000;
-  } else {
-    buffer[y * EmuConst::SCREEN_WIDTH + x] = EmuConst::colors[colorIndex] | 0xFF00'0000;
-  }
+void Display::setPalette(const Palette& newPalette) {
+  palette = newPalette;
 }
 
 void Display::updateScreen() {
+  if (isLocked)
+    SDL_UnlockTexture(texture);
+  else
+    SDL_UpdateTexture(texture, nullptr, pixels, pitch * static_cast<int>(sizeof(uint32_t)));
+
   SDL_RenderClear(renderer);
-  SDL_UpdateTexture(texture, nullptr, buffer, EmuConst::SCREEN_WIDTH * sizeof(uint32_t));
   SDL_RenderCopy(renderer, texture, nullptr, &screenRect);
   SDL_RenderPresent(renderer);
+  beginFrame();
+}
+
+void Display::presentFrame(const uint16_t* frame) {
+  for (int y{}; y < EmuConst::SCREEN_HEIGHT; y++) {
+    convertIndexed(&frame[y * EmuConst::SCREEN_WIDTH], EmuConst::SCREEN_WIDTH, palette.getIndexedTable(),
+                   &pixels[y * pitch]);
+  }
+  updateScreen();
 }
 
-void Display::clearBuffer() {
-  memset(buffer, 0, EmuConst::SCREEN_WIDTH * EmuConst::SCREEN_HEIGHT * sizeof(uint32_t));
-}
\ No newline at end of file
+void Display::beginFrame() {
+  void* lockedPixels{};
+  int lockedPitch{};
+  isLocked = isLockable && SDL_LockTexture(texture, nullptr, &lockedPixels, &lockedPitch) == 0;
+  if (isLocked) {
+    pixels = static_cast<uint32_t*>(lockedPixels);
+    pitch = lockedPitch / static_cast<int>(sizeof(uint32_t));
+    return;
+  }
+
+  if (isLockable) {
+    printf("Cannot lock texture, copying frames instead! SDL Error: %s\n", SDL_GetError());
+    isLockable = false;
+  }
+
+  // Each buffer keeps the frame drawn into it 2 frames ago, which the PPU draws over entirely
+  backBuffer ^= 1;
+  buffers[backBuffer].resize(EmuConst::SCREEN_WIDTH * EmuConst::SCREEN_HEIGHT);
+  pixels = buffers[backBuffer].data();
+  pitch = EmuConst::SCREEN_WIDTH;
+}
@@ -2,21 +2,60 @@
 #define NESEMULATOR_DISPLAY_H
 
 #include "SDL.h"
+#include "frame_sink.h"
+#include "palette.h"
+#include <array>
+#include <vector>
 
-class Display {
+/**
+ * \brief FrameSink that presents frames in an SDL window
+ * \note The front end emulates on its own thread into a TripleBufferSink and presents with presentFrame(). Using
+ * Display as the FrameSink of the PPU, through drawPixel() and drawScanline(), is only for single-threaded use
+ */
+class Display : public FrameSink {
 public:
+  /**
+   * \param texture a SCREEN_WIDTH x SCREEN_HEIGHT ARGB8888 streaming texture
+   * \note With an accelerated renderer frames are converted straight into the pixels of the locked texture, which
+   * stays locked until the frame is presented. Otherwise, or if the texture cannot be locked, frames are converted
+   * into 2 buffers in turn and copied into the texture when presented
+   */
   Display(SDL_Renderer* renderer, SDL_Texture* texture);
-  ~Display();
 
-  void drawPixel(int x, int y, uint8_t colorIndex, uint8_t ppuMask);
-  void updateScreen();
-  void clearBuffer();
+  void drawPixel(int x, int y, uint8_t colorIndex, uint8_t ppuMask) override;
+  void drawScanline(int y, const uint8_t* colorIndices, uint8_t ppuMask) override;
+  void updateScreen() override;
+
+  /**
+   * \brief Convert a frame of indexed pixels (see IndexedSink) and present it, for frames drawn into another sink
+   * \param frame SCREEN_WIDTH * SCREEN_HEIGHT pixels in row-major order
+   */
+  void presentFrame(const uint16_t* frame);
+
+  /**
+   * \brief Convert the pixels of the following frames with newPalette
+   */
+  void setPalette(const Palette& newPalette);
 
 private:
+  /**
+   * \brief Get the pixels of the next frame, locking the texture or switching to the other buffer
+   */
+  void beginFrame();
+
   SDL_Renderer* renderer;
   SDL_Texture* texture;
-  uint32_t* buffer;
   SDL_Rect screenRect;
+  Palette palette;
+
+  bool isLockable;
+  bool isLocked;
+  uint32_t* pixels; // The frame being drawn, pitch pixels per line
+  int pitch;
+
+  // Used when the texture is not locked, the frame being drawn and the last presented one
+  std::array<std::vector<uint32_t>, 2> buffers;
+  int backBuffer;
 };
 
 #endif
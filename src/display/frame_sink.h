@@ -0,0 +1,44 @@
+#ifndef NESEMULATOR_FRAME_SINK_H
+#define NESEMULATOR_FRAME_SINK_H
+
+#include "../constants.h"
+
+/**
+ * \brief Destination of the pixels produced by the PPU
+ * \note Implementations decide what a frame becomes (an SDL texture, a memory buffer, nothing at all),
+ * so the emulation core never has to know about the presentation layer
+ */
+class FrameSink {
+public:
+  virtual ~FrameSink() = default;
+
+  /**
+   * \brief Receive one pixel of the frame currently being rendered
+   * \param x the x-position, 0 to 255
+   * \param y the y-position, 0 to 239
+   * \param colorIndex the NES colour index (0 to 63) read from palette memory
+   * \param ppuMask the PPUMASK value at the time the pixel was drawn (used for colour emphasis)
+   */
+  virtual void drawPixel(int x, int y, Byte colorIndex, Byte ppuMask) = 0;
+
+  /**
+   * \brief Receive a whole line of the frame currently being rendered
+   * \param y the y-position, 0 to 239
+   * \param colorIndices SCREEN_WIDTH NES colour indices, one per x-position
+   * \param ppuMask the PPUMASK value for the whole line
+   * \note Defaults to drawPixel() on every pixel of the line
+   */
+  virtual void drawScanline(int y, const Byte* colorIndices, Byte ppuMask) {
+    for (int x{}; x < EmuConst::SCREEN_WIDTH; x++)
+      drawPixel(x, y, colorIndices[x], ppuMask);
+  }
+
+  /**
+   * \brief Called by the PPU at the start of vblank once every pixel of the frame has been drawn
+   * \note Every pixel of a frame is drawn again in the next one, so the pixels kept from the previous frame never
+   * have to be cleared
+   */
+  virtual void updateScreen() = 0;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#include "indexed_sink.h"
+
+IndexedSink::IndexedSink() : buffer(EmuConst::SCREEN_WIDTH * EmuConst::SCREEN_HEIGHT),
+frame(EmuConst::SCREEN_WIDTH * EmuConst::SCREEN_HEIGHT), frameCount{} {}
+
+void IndexedSink::drawPixel(int x, int y, Byte colorIndex, Byte ppuMask) {
+  buffer[y * EmuConst::SCREEN_WIDTH + x] = getIndexedPixel(colorIndex, ppuMask);
+}
+
+void IndexedSink::drawScanline(int y, const Byte* colorIndices, Byte ppuMask) {
+  getIndexedLine(colorIndices, ppuMask, &buffer[y * EmuConst::SCREEN_WIDTH]);
+}
+
+void IndexedSink::getIndexedLine(const Byte* colorIndices, Byte ppuMask, uint16_t* out) {
+  const uint16_t emphasis{ static_cast<uint16_t>((ppuMask >> 5) << 6) };
+  for (int x{}; x < EmuConst::SCREEN_WIDTH; x++)
+    out[x] = (colorIndices[x] & 0x3F) | emphasis;
+}
+
+void IndexedSink::updateScreen() {
+  frame.swap(buffer);
+  frameCount++;
+}
+
+const std::vector<uint16_t>& IndexedSink::getFrame() const {
+  return frame;
+}
+
+void IndexedSink::convertFrame(const Palette& palette, std::vector<uint32_t>& out) const {
+  out.resize(frame.size());
+  convertIndexed(frame.data(), static_cast<int>(frame.size()), palette.getIndexedTable(), out.data());
+}
+
+uint64_t IndexedSink::getFrameCount() const {
+  return frameCount;
+}
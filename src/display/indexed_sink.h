@@ -0,0 +1,62 @@
+#ifndef NESEMULATOR_INDEXED_SINK_H
+#define NESEMULATOR_INDEXED_SINK_H
+
+#include "frame_sink.h"
+#include "palette.h"
+#include <vector>
+#include <cstdint>
+
+/**
+ * \brief FrameSink that keeps the last completed frame as indexed pixels, converting to ARGB8888 only when asked to
+ * \note A pixel is the NES colour index in bit 0 to bit 5 and PPUMASK bit 5 to bit 7 (colour emphasis) in bit 6 to
+ * bit 8, so it holds everything the colour depends on in half the memory of an ARGB8888 pixel. Consumers hashing
+ * or downsampling frames never have to convert them
+ */
+class IndexedSink : public FrameSink {
+public:
+  IndexedSink();
+
+  static uint16_t getIndexedPixel(Byte colorIndex, Byte ppuMask) {
+    return (colorIndex & 0x3F) | ((ppuMask >> 5) << 6);
+  }
+
+  /**
+   * \brief getIndexedPixel() of SCREEN_WIDTH colour indices under the same ppuMask
+   */
+  static void getIndexedLine(const Byte* colorIndices, Byte ppuMask, uint16_t* out);
+
+  void drawPixel(int x, int y, Byte colorIndex, Byte ppuMask) override;
+  void drawScanline(int y, const Byte* colorIndices, Byte ppuMask) override;
+  void updateScreen() override;
+
+  /**
+   * \brief Get the last completed frame, SCREEN_WIDTH * SCREEN_HEIGHT indexed pixels in row-major order
+   * \note All pixels are 0 until the first frame is completed
+   */
+  [[nodiscard]] const std::vector<uint16_t>& getFrame() const;
+
+  /**
+   * \brief Convert the last completed frame to ARGB8888 pixels with palette, out is resized to fit
+   */
+  void convertFrame(const Palette& palette, std::vector<uint32_t>& out) const;
+
+  /**
+   * \brief Get the number of frames completed so far
+   */
+  [[nodiscard]] uint64_t getFrameCount() const;
+
+private:
+  /**
+   * \brief The frame currently being drawn by the PPU
+   */
+  std::vector<uint16_t> buffer;
+
+  /**
+   * \brief The last completed frame
+   */
+  std::vector<uint16_t> frame;
+
+  uint64_t frameCount;
+};
+
+#endif
@@ -0,0 +1,30 @@
+#include "memory_sink.h"
+#include "palette.h"
+
+MemorySink::MemorySink() : buffer(EmuConst::SCREEN_WIDTH * EmuConst::SCREEN_HEIGHT),
+frame(EmuConst::SCREEN_WIDTH * EmuConst::SCREEN_HEIGHT), frameCount{} {}
+
+void MemorySink::drawPixel(int x, int y, Byte colorIndex, Byte ppuMask) {
+  buffer[y * EmuConst::SCREEN_WIDTH + x] = palette.convert(colorIndex, ppuMask);
+}
+
+void MemorySink::drawScanline(int y, const Byte* colorIndices, Byte ppuMask) {
+  convertLine(colorIndices, palette.getTable(ppuMask), &buffer[y * EmuConst::SCREEN_WIDTH]);
+}
+
+void MemorySink::setPalette(const Palette& newPalette) {
+  palette = newPalette;
+}
+
+void MemorySink::updateScreen() {
+  frame.swap(buffer);
+  frameCount++;
+}
+
+const std::vector<uint32_t>& MemorySink::getFrame() const {
+  return frame;
+}
+
+uint64_t MemorySink::getFrameCount() const {
+  return frameCount;
+}
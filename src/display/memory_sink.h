@@ -0,0 +1,52 @@
+#ifndef NESEMULATOR_MEMORY_SINK_H
+#define NESEMULATOR_MEMORY_SINK_H
+
+#include "frame_sink.h"
+#include "palette.h"
+#include <vector>
+#include <cstdint>
+
+/**
+ * \brief FrameSink that keeps the last completed frame in memory as ARGB8888 pixels
+ */
+class MemorySink : public FrameSink {
+public:
+  MemorySink();
+
+  void drawPixel(int x, int y, Byte colorIndex, Byte ppuMask) override;
+  void drawScanline(int y, const Byte* colorIndices, Byte ppuMask) override;
+  void updateScreen() override;
+
+  /**
+   * \brief Convert the pixels of the following frames with newPalette
+   */
+  void setPalette(const Palette& newPalette);
+
+  /**
+   * \brief Get the last completed frame, SCREEN_WIDTH * SCREEN_HEIGHT pixels in row-major order
+   * \note All pixels are 0 until the first frame is completed
+   */
+  [[nodiscard]] const std::vector<uint32_t>& getFrame() const;
+
+  /**
+   * \brief Get the number of frames completed so far
+   */
+  [[nodiscard]] uint64_t getFrameCount() const;
+
+private:
+  Palette palette;
+
+  /**
+   * \brief The frame currently being drawn by the PPU
+   */
+  std::vector<uint32_t> buffer;
+
+  /**
+   * \brief The last completed frame
+   */
+  std::vector<uint32_t> frame;
+
+  uint64_t frameCount;
+};
+
+#endif
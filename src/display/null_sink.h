@@ -0,0 +1,22 @@
+#ifndef NESEMULATOR_NULL_SINK_H
+#define NESEMULATOR_NULL_SINK_H
+
+#include "frame_sink.h"
+#include <cstdint>
+
+/**
+ * \brief FrameSink that discards every pixel, only counting the completed frames
+ */
+class NullSink : public FrameSink {
+public:
+  void drawPixel(int /*x*/, int /*y*/, Byte /*colorIndex*/, Byte /*ppuMask*/) override {}
+  void drawScanline(int /*y*/, const Byte* /*colorIndices*/, Byte /*ppuMask*/) override {}
+  void updateScreen() override { frameCount++; }
+
+  [[nodiscard]] uint64_t getFrameCount() const { return frameCount; }
+
+private:
+  uint64_t frameCount{};
+};
+
+#endif
@@ -0,0 +1,179 @@
+#include "palette.h"
+#include "../simd.h"
+#include <fstream>
+#include <iterator>
+
+#ifdef NES_SIMD_X86
+#include <immintrin.h>
+#endif
+
+static uint32_t applyEmphasis(uint32_t color, Byte ppuMask) {
+  if (ppuMask & 0b1110'0000) {
+    Byte red = (color & 0xFF0000) >> 16;
+    Byte green = (color & 0xFF00) >> 8;
+    Byte blue = color & 0xFF;
+
+    bool emphasiseRed{};
+    bool emphasiseGreen{};
+    bool emphasiseBlue{};
+
+    if (ppuMask & 0b0010'0000)
+      emphasiseRed = true;
+
+    if (ppuMask & 0b0100'0000)
+      emphasiseGreen = true;
+
+    if (ppuMask & 0b1000'0000)
+      emphasiseBlue = true;
+
+    float baseReduce{ 2.0 / 3.0 };
+
+    // Ignore warnings here
+    if (emphasiseRed && emphasiseGreen && emphasiseBlue) {
+      red *= baseReduce;
+      green *= baseReduce;
+      blue *= baseReduce;
+    } else if (emphasiseRed && emphasiseGreen) {
+      red *= 0.75;
+      green *= 0.75;
+      blue *= 0.40;
+    } else if (emphasiseGreen && emphasiseBlue) {
+      red *= 0.40;
+      green *= 0.75;
+      blue *= 0.75;
+    } else if (emphasiseRed && emphasiseBlue) {
+      red *= 0.75;
+      green *= 0.40;
+      blue *= 0.75;
+    } else if (emphasiseRed) {
+      green *= baseReduce;
+      blue *= baseReduce;
+    } else if (emphasiseGreen) {
+      red *= baseReduce;
+      blue *= baseReduce;
+    } else {
+      red *= baseReduce;
+      green *= baseReduce;
+    }
+
+    return (red << 16) | (green << 8) | blue | 0xFF00'0000;
+  }
+
+  return color | 0xFF00'0000;
+}
+
+uint32_t convertToARGB(Byte colorIndex, Byte ppuMask) {
+  return applyEmphasis(EmuConst::colors[colorIndex], ppuMask);
+}
+
+Palette::Palette() : table{} {
+  reset();
+}
+
+void Palette::reset() {
+  build(EmuConst::colors.data());
+}
+
+std::string Palette::loadFile(const std::string& fileName) {
+  std::ifstream file{ fileName, std::ios_base::binary };
+  if (!file)
+    return "Cannot open palette file " + fileName;
+
+  const std::vector<Byte> data{ std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{} };
+  return loadData(data);
+}
+
+std::string Palette::loadData(const std::vector<Byte>& data) {
+  const auto readColor{ [&data](int offset) {
+    return static_cast<uint32_t>(data[offset] << 16 | data[offset + 1] << 8 | data[offset + 2]);
+  } };
+
+  if (data.size() == COLOR_COUNT * 3) {
+    std::array<uint32_t, COLOR_COUNT> colors;
+    for (int i{}; i < COLOR_COUNT; i++)
+      colors[i] = readColor(i * 3);
+    build(colors.data());
+    return "";
+  }
+
+  // Every emphasis combination in PPUMASK bit 5 to bit 7 order, as measured rather than approximated
+  if (data.size() == EMPHASIS_COUNT * COLOR_COUNT * 3) {
+    for (int emphasis{}; emphasis < EMPHASIS_COUNT; emphasis++)
+      for (int i{}; i < COLOR_COUNT; i++)
+        table[emphasis * COLOR_COUNT + i] = readColor((emphasis * COLOR_COUNT + i) * 3) | 0xFF00'0000;
+    return "";
+  }
+
+  return "Palette file must be 192 or 1536 bytes, got " + std::to_string(data.size());
+}
+
+void Palette::build(const uint32_t* colors) {
+  for (int emphasis{}; emphasis < EMPHASIS_COUNT; emphasis++)
+    for (int i{}; i < COLOR_COUNT; i++)
+      table[emphasis * COLOR_COUNT + i] = applyEmphasis(colors[i], emphasis << 5);
+}
+
+void convertLineScalar(const Byte* colorIndices, const uint32_t* table, uint32_t* out) {
+  for (int x{}; x < EmuConst::SCREEN_WIDTH; x++)
+    out[x] = table[colorIndices[x] & 0x3F];
+}
+
+#ifdef NES_SIMD_X86
+NES_TARGET_AVX2
+void convertLineAVX2(const Byte* colorIndices, const uint32_t* table, uint32_t* out) {
+  const int* entries{ reinterpret_cast<const int*>(table) };
+  const __m256i indexMask{ _mm256_set1_epi32(0x3F) };
+
+  // 8 indices widened to 32 bit per gather, a 64 entry table stays in L1 so the gathers do not miss
+  for (int x{}; x < EmuConst::SCREEN_WIDTH; x += 8) {
+    const __m128i indices{ _mm_loadl_epi64(reinterpret_cast<const __m128i*>(colorIndices + x)) };
+    const __m256i offsets{ _mm256_and_si256(_mm256_cvtepu8_epi32(indices), indexMask) };
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), _mm256_i32gather_epi32(entries, offsets, 4));
+  }
+}
+#else
+void convertLineAVX2(const Byte* colorIndices, const uint32_t* table, uint32_t* out) {
+  convertLineScalar(colorIndices, table, out);
+}
+#endif
+
+void convertLine(const Byte* colorIndices, const uint32_t* table, uint32_t* out) {
+  // Without a gather instruction a table lookup cannot be vectorised, SSE2 uses the scalar loop
+  if (getSimdLevel() == SimdLevel::AVX2)
+    convertLineAVX2(colorIndices, table, out);
+  else
+    convertLineScalar(colorIndices, table, out);
+}
+
+void convertIndexedScalar(const uint16_t* pixels, int count, const uint32_t* table, uint32_t* out) {
+  for (int i{}; i < count; i++)
+    out[i] = table[pixels[i] & 0x1FF];
+}
+
+#ifdef NES_SIMD_X86
+NES_TARGET_AVX2
+void convertIndexedAVX2(const uint16_t* pixels, int count, const uint32_t* table, uint32_t* out) {
+  const int* entries{ reinterpret_cast<const int*>(table) };
+  const __m256i indexMask{ _mm256_set1_epi32(0x1FF) };
+
+  // The 2 KB table still fits in L1 next to the pixels streaming through
+  int i{};
+  for (; i + 8 <= count; i += 8) {
+    const __m128i indices{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i)) };
+    const __m256i offsets{ _mm256_and_si256(_mm256_cvtepu16_epi32(indices), indexMask) };
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_i32gather_epi32(entries, offsets, 4));
+  }
+  convertIndexedScalar(pixels + i, count - i, table, out + i);
+}
+#else
+void convertIndexedAVX2(const uint16_t* pixels, int count, const uint32_t* table, uint32_t* out) {
+  convertIndexedScalar(pixels, count, table, out);
+}
+#endif
+
+void convertIndexed(const uint16_t* pixels, int count, const uint32_t* table, uint32_t* out) {
+  if (getSimdLevel() == SimdLevel::AVX2)
+    convertIndexedAVX2(pixels, count, table, out);
+  else
+    convertIndexedScalar(pixels, count, table, out);
+}
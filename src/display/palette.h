@@ -0,0 +1,105 @@
+#ifndef NESEMULATOR_PALETTE_H
+#define NESEMULATOR_PALETTE_H
+
+#include "../constants.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * \brief Convert a NES colour index to an ARGB8888 pixel of the default palette, applying the colour emphasis bits
+ * of PPUMASK
+ * \param colorIndex the NES colour index (0 to 63)
+ * \param ppuMask the PPUMASK value, only bit 5 to bit 7 are used
+ */
+uint32_t convertToARGB(Byte colorIndex, Byte ppuMask);
+
+/**
+ * \brief The ARGB8888 pixel of every NES colour index under every combination of the colour emphasis bits
+ * \note Built once when created or loaded, so converting a pixel is a single lookup whatever PPUMASK is. Greyscale
+ * is already applied to the colour index by the PPU
+ */
+class Palette {
+public:
+  static constexpr int COLOR_COUNT{ 64 };
+  static constexpr int EMPHASIS_COUNT{ 8 };
+
+  /**
+   * \brief Create the default palette, EmuConst::colors with emphasis as done by convertToARGB()
+   */
+  Palette();
+
+  /**
+   * \brief Go back to the default palette
+   */
+  void reset();
+
+  /**
+   * \brief Load a .pal file, see loadData()
+   * \return empty string if loaded, otherwise the reason it was not. The palette is unchanged on failure
+   */
+  std::string loadFile(const std::string& fileName);
+
+  /**
+   * \brief Load the content of a .pal file, 3 bytes (R, G, B) per colour
+   * \note 192 bytes hold the 64 colours, the emphasised ones are derived like convertToARGB() does.
+   * 1536 bytes hold the 64 colours for each of the 8 emphasis combinations, in PPUMASK bit 5 to bit 7 order
+   * \return empty string if loaded, otherwise the reason it was not. The palette is unchanged on failure
+   */
+  std::string loadData(const std::vector<Byte>& data);
+
+  /**
+   * \brief Get the 64 ARGB8888 pixels of the colour indices under ppuMask, only bit 5 to bit 7 are used
+   */
+  [[nodiscard]] const uint32_t* getTable(Byte ppuMask) const {
+    return &table[(ppuMask >> 5) * COLOR_COUNT];
+  }
+
+  [[nodiscard]] uint32_t convert(Byte colorIndex, Byte ppuMask) const {
+    return table[(ppuMask >> 5) * COLOR_COUNT + (colorIndex & 0x3F)];
+  }
+
+  /**
+   * \brief Get the 512 ARGB8888 pixels of the indexed pixels, colour index | PPUMASK bit 5 to bit 7 << 6
+   * \note The tables of getTable() one after the other, see IndexedSink
+   */
+  [[nodiscard]] const uint32_t* getIndexedTable() const {
+    return table.data();
+  }
+
+private:
+  /**
+   * \brief Fill the table from 64 RGB colours, deriving the emphasised ones
+   */
+  void build(const uint32_t* colors);
+
+  // The 64 colours of each emphasis combination one after the other, indexed by colour index | emphasis << 6
+  std::array<uint32_t, EMPHASIS_COUNT * COLOR_COUNT> table;
+};
+
+/**
+ * \brief Convert a line of NES colour indices to ARGB8888 pixels
+ * \param colorIndices SCREEN_WIDTH colour indices, only the low 6 bits are used
+ * \param table the 64 pixels to convert with, Palette::getTable()
+ * \param out SCREEN_WIDTH pixels
+ * \note Runs the kernel of getSimdLevel(), every kernel gives the same result
+ */
+void convertLine(const Byte* colorIndices, const uint32_t* table, uint32_t* out);
+
+void convertLineScalar(const Byte* colorIndices, const uint32_t* table, uint32_t* out);
+void convertLineAVX2(const Byte* colorIndices, const uint32_t* table, uint32_t* out);
+
+/**
+ * \brief Convert indexed pixels to ARGB8888 pixels
+ * \param pixels count pixels, colour index | emphasis << 6, only the low 9 bits are used
+ * \param table the 512 pixels to convert with, Palette::getIndexedTable()
+ * \param out count pixels
+ * \note Runs the kernel of getSimdLevel(), every kernel gives the same result
+ */
+void convertIndexed(const uint16_t* pixels, int count, const uint32_t* table, uint32_t* out);
+
+void convertIndexedScalar(const uint16_t* pixels, int count, const uint32_t* table, uint32_t* out);
+void convertIndexedAVX2(const uint16_t* pixels, int count, const uint32_t* table, uint32_t* out);
+
+#endif
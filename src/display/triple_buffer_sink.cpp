@@ -0,0 +1,26 @@
+#include "triple_buffer_sink.h"
+#include "indexed_sink.h"
+
+TripleBufferSink::TripleBufferSink() : frames{std::vector<uint16_t>(EmuConst::SCREEN_WIDTH * EmuConst::SCREEN_HEIGHT)},
+buffer{frames.getBack().data()} {}
+
+void TripleBufferSink::drawPixel(int x, int y, Byte colorIndex, Byte ppuMask) {
+  buffer[y * EmuConst::SCREEN_WIDTH + x] = IndexedSink::getIndexedPixel(colorIndex, ppuMask);
+}
+
+void TripleBufferSink::drawScanline(int y, const Byte* colorIndices, Byte ppuMask) {
+  IndexedSink::getIndexedLine(colorIndices, ppuMask, &buffer[y * EmuConst::SCREEN_WIDTH]);
+}
+
+void TripleBufferSink::updateScreen() {
+  frames.publish();
+  buffer = frames.getBack().data();
+}
+
+bool TripleBufferSink::acquireFrame() {
+  return frames.acquire();
+}
+
+const std::vector<uint16_t>& TripleBufferSink::getFrame() const {
+  return frames.getFront();
+}
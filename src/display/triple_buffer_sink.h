@@ -0,0 +1,40 @@
+#ifndef NESEMULATOR_TRIPLE_BUFFER_SINK_H
+#define NESEMULATOR_TRIPLE_BUFFER_SINK_H
+
+#include "frame_sink.h"
+#include "../threading/triple_buffer.h"
+#include <vector>
+#include <cstdint>
+
+/**
+ * \brief FrameSink handing completed frames from the emulation thread to another thread, as indexed pixels
+ * \note Pixels are the same as IndexedSink::getIndexedPixel(). The PPU side never waits: the consumer gets the latest
+ * completed frame whenever it asks for one, frames completed in between are dropped
+ */
+class TripleBufferSink : public FrameSink {
+public:
+  TripleBufferSink();
+
+  // Called by the PPU, on the emulation thread
+  void drawPixel(int x, int y, Byte colorIndex, Byte ppuMask) override;
+  void drawScanline(int y, const Byte* colorIndices, Byte ppuMask) override;
+  void updateScreen() override;
+
+  // Called by the consumer thread
+  /**
+   * \brief Take the latest completed frame
+   * \return false if no frame was completed since the last call, getFrame() is unchanged then
+   */
+  bool acquireFrame();
+
+  /**
+   * \brief Get the frame taken by acquireFrame(), SCREEN_WIDTH * SCREEN_HEIGHT indexed pixels in row-major order
+   */
+  [[nodiscard]] const std::vector<uint16_t>& getFrame() const;
+
+private:
+  TripleBuffer<std::vector<uint16_t>> frames;
+  uint16_t* buffer; // Back buffer of frames, the frame currently being drawn by the PPU
+};
+
+#endif
@@ -0,0 +1,92 @@
+#include "frame_pacer.h"
+#include <thread>
+
+FramePacer::FramePacer(PacingMode mode, double frameRate) : mode{mode}, framePeriod{1e9 / frameRate}, hostStats{},
+start{Clock::now()}, frame{} {}
+
+void FramePacer::waitForNextFrame() {
+  if (mode == PacingMode::NONE)
+    return;
+
+  frame++;
+  const Clock::time_point deadline{ start + std::chrono::duration_cast<Clock::duration>(frame * framePeriod) };
+
+  if (mode == PacingMode::TIMER) {
+    HostStats::Scope scope{hostStats, Subsystem::PACING};
+    if (Clock::now() < deadline - SPIN_TIME)
+      std::this_thread::sleep_until(deadline - SPIN_TIME);
+    while (Clock::now() < deadline)
+      std::this_thread::yield();
+  }
+
+  const Clock::time_point now{ Clock::now() };
+  const int64_t late{ std::chrono::duration_cast<std::chrono::nanoseconds>(now - deadline).count() };
+  const bool isMissed{ late > framePeriod.count() };
+  if (hostStats)
+    hostStats->addPacedFrame(late, isMissed);
+
+  if (isMissed)
+    reset();
+}
+
+void FramePacer::reset() {
+  start = Clock::now();
+  frame = 0;
+}
+
+void FramePacer::setMode(PacingMode newMode) {
+  mode = newMode;
+  reset();
+}
+
+PacingMode FramePacer::getMode() const {
+  return mode;
+}
+
+void FramePacer::setHostStats(HostStats* stats) {
+  hostStats = stats;
+}
+
+FastForward::FastForward(int presentEvery, double maxPresentRate) : presentEvery{presentEvery},
+presentPeriod{1e9 / maxPresentRate}, frame{}, lastPresent{}, intervalStart{}, intervalCycles{}, speed{} {
+  reset();
+}
+
+bool FastForward::isNextFramePresented() {
+  frame++;
+  if (presentEvery > 0)
+    return frame % presentEvery == 0;
+
+  const Clock::time_point now{ Clock::now() };
+  if (now - lastPresent < presentPeriod)
+    return false;
+
+  lastPresent = now;
+  return true;
+}
+
+bool FastForward::endFrame(uint64_t emulatedCycles) {
+  intervalCycles += emulatedCycles;
+
+  const Clock::time_point now{ Clock::now() };
+  if (now - intervalStart < SPEED_INTERVAL)
+    return false;
+
+  const double seconds{ std::chrono::duration<double>(now - intervalStart).count() };
+  speed = intervalCycles / EmuConst::CPU_FREQUENCY / seconds;
+  intervalStart = now;
+  intervalCycles = 0;
+  return true;
+}
+
+double FastForward::getSpeed() const {
+  return speed;
+}
+
+void FastForward::reset() {
+  frame = 0;
+  lastPresent = Clock::now() - std::chrono::duration_cast<Clock::duration>(presentPeriod);
+  intervalStart = Clock::now();
+  intervalCycles = 0;
+  speed = 0.0;
+}
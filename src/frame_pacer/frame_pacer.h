@@ -0,0 +1,111 @@
+#ifndef NESEMULATOR_FRAME_PACER_H
+#define NESEMULATOR_FRAME_PACER_H
+
+#include "../constants.h"
+#include "../stats/host_stats.h"
+#include <chrono>
+#include <cstdint>
+
+/**
+ * \brief What the front end waits on between 2 frames
+ */
+enum class PacingMode {
+  TIMER, // FramePacer sleeps until the deadline of the frame
+  VSYNC, // Presenting the frame blocks until the display refreshes, FramePacer only measures
+  NONE   // Run as fast as possible
+};
+
+/**
+ * \brief Keeps emulated frames at the NTSC frame rate on the host clock
+ * \note Deadlines are kept on an absolute schedule, frame n is due at start + n / FRAME_RATE, so sleeping too long
+ * once does not slow down the frames after it. Waiting sleeps until shortly before the deadline, as the OS wakes
+ * threads up late by up to a millisecond or so, and spins the rest. A frame finished more than a whole frame late
+ * counts as a missed deadline and starts the schedule over from now instead of rushing to catch up
+ */
+class FramePacer {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr std::chrono::nanoseconds SPIN_TIME{ 2'000'000 };
+
+  explicit FramePacer(PacingMode mode = PacingMode::TIMER, double frameRate = EmuConst::FRAME_RATE);
+
+  /**
+   * \brief Wait until the deadline of the frame just emulated, then move on to the next one
+   * \note In VSYNC mode this returns right away, still measuring how far off the schedule the frame was. In NONE
+   * mode it only returns
+   */
+  void waitForNextFrame();
+
+  /**
+   * \brief Start the schedule over from now, after the emulation was paused
+   */
+  void reset();
+
+  void setMode(PacingMode newMode);
+  [[nodiscard]] PacingMode getMode() const;
+
+  /**
+   * \brief Count every paced frame into stats, nullptr to stop counting
+   */
+  void setHostStats(HostStats* stats);
+
+private:
+  PacingMode mode;
+  std::chrono::duration<double, std::nano> framePeriod;
+  HostStats* hostStats;
+
+  Clock::time_point start;
+  uint64_t frame; // Frames since start, the next deadline is start + frame * framePeriod
+};
+
+/**
+ * \brief Picks the frames to present while running as fast as possible, and measures the speed reached
+ * \note Frames that are not presented can be run without drawing them, see PPU::setRenderEnabled()
+ */
+class FastForward {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr std::chrono::milliseconds SPEED_INTERVAL{ 500 };
+
+  /**
+   * \param presentEvery present every presentEvery-th frame, 0 to present as often as maxPresentRate allows
+   * \param maxPresentRate most frames presented per host second when presentEvery is 0
+   */
+  explicit FastForward(int presentEvery = 0, double maxPresentRate = EmuConst::FRAME_RATE);
+
+  /**
+   * \brief Decide whether the next frame is presented, called once before emulating every frame
+   */
+  bool isNextFramePresented();
+
+  /**
+   * \brief Count a frame emulated in fast forward
+   * \return true if a new speed is available from getSpeed(), every SPEED_INTERVAL
+   */
+  bool endFrame(uint64_t emulatedCycles);
+
+  /**
+   * \brief Get the emulated time per host time over the last SPEED_INTERVAL, 1.0 is real time
+   */
+  [[nodiscard]] double getSpeed() const;
+
+  /**
+   * \brief Start measuring and presenting over, when fast forward is entered
+   */
+  void reset();
+
+private:
+  int presentEvery;
+  std::chrono::duration<double, std::nano> presentPeriod;
+
+  uint64_t frame; // Frames since reset()
+  Clock::time_point lastPresent;
+
+  Clock::time_point intervalStart;
+  uint64_t intervalCycles;
+  double speed;
+};
+
+#endif
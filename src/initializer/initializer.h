@@ -14,7 +14,7 @@ private:
   PPU& ppu;
   CPU& cpu;
 public:
-  Initializer(CPU& cpu, PPU& ppu) : cpu{cpu}, ppu{ppu} {};
+  Initializer(CPU& cpu, PPU& ppu) : ppu{ppu}, cpu{cpu} {};
 
   std::string loadFile(std::string fileName) {
     std::ifstream file{ fileName, std::ios_base::binary };
@@ -102,7 +102,10 @@ public:
       }
     }
 
-    ppu.nametableArrangement = nametableArrangement;
+    if (isAlternativeNametableLayoutPresent)
+      ppu.setMirroring(Mirroring::FOUR_SCREEN);
+    else
+      ppu.setMirroring(nametableArrangement ? Mirroring::VERTICAL : Mirroring::HORIZONTAL);
 
     // TODO: find out more about this
 //    if (isPrgRamPresent) {
@@ -116,17 +119,16 @@ public:
 //      }
 //    }
 
-    if (prgRomSize == 1) {
-      for (int i{}; i < 0x4000; i++) {
+    if (prgRomSize == 1 || prgRomSize == 2) {
+      cpu.prgRom.resize(prgRomSize * 0x4000);
+      for (int i{}; i < prgRomSize * 0x4000; i++) {
         file.read(reinterpret_cast<char*>(&current), 1);
-        cpu.memory[0x8000 + i] = current;
-        cpu.memory[0xC000 + i] = current;
-      }
-    } else if (prgRomSize == 2) {
-      for (int i{}; i < 0x8000; i++) {
-        file.read(reinterpret_cast<char*>(&current), 1);
-        cpu.memory[0x8000 + i] = current;
+        cpu.prgRom[i] = current;
       }
+
+      // NROM-128 mirrors its single 16KB bank into $C000 - $FFFF
+      cpu.mapPages(0x80, 0x40, &cpu.prgRom[0], false);
+      cpu.mapPages(0xC0, 0x40, &cpu.prgRom[(prgRomSize - 1) * 0x4000], false);
     } else {
       return "More than 32KB PRG ROM was specified\n";
     }
@@ -136,6 +138,7 @@ public:
         file.read(reinterpret_cast<char*>(&current), 1);
         ppu.memory[i] = current;
       }
+      ppu.tileCache.rebuild();
     } else {
       if (chrRomSize != 0)
         return "More than 8KB CHR ROM was specified\n";
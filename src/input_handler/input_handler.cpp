@@ -2,80 +2,18 @@
 #include <cstdint>
 #include <cstdio>
 
-constexpr Byte A        = 0b0000'0001;
-constexpr Byte B        = 0b0000'0010;
-constexpr Byte SELECT   = 0b0000'0100;
-constexpr Byte START    = 0b0000'1000;
-constexpr Byte UP       = 0b0001'0000;
-constexpr Byte DOWN     = 0b0010'0000;
-constexpr Byte LEFT     = 0b0100'0000;
-constexpr Byte RIGHT    = 0b1000'0000;
+InputHandler::InputHandler() : poll{}, input{}, readState{} {}
 
-InputHandler::InputHandler() : input{}, poll{}, readState{} {}
-
-void InputHandler::handleEvent(SDL_Event& event) {
-  // TODO: Implement polling input
-
-  // Only handle keydown event
-  if (event.type == SDL_KEYUP)
-    return;
-
-  switch (event.key.keysym.sym) {
-    case SDLK_a:
-      input |= A;
-      break;
-    case SDLK_b:
-      input |= B;
-      break;
-    case SDLK_q:
-      input |= SELECT;
-      break;
-    case SDLK_e:
-      input |= START;
-      break;
-    case SDLK_UP:
-      input |= UP;
-      break;
-    case SDLK_DOWN:
-      input |= DOWN;
-      break;
-    case SDLK_LEFT:
-      input |= LEFT;
-      break;
-    case SDLK_RIGHT:
-      input |= RIGHT;
-      break;
-    default:
-      break;
-  }
+void InputHandler::pressButton(Byte button) {
+  input |= button;
 }
 
-void InputHandler::handleKeyboardState() {
-  const Byte* keyboardState{SDL_GetKeyboardState(nullptr) };
-
-  if (keyboardState[SDL_SCANCODE_Q])
-    input |= SELECT;
-
-  if (keyboardState[SDL_SCANCODE_E])
-    input |= START;
-
-  if (keyboardState[SDL_SCANCODE_A])
-    input |= A;
-
-  if (keyboardState[SDL_SCANCODE_B])
-    input |= B;
-
-  if (keyboardState[SDL_SCANCODE_LEFT])
-    input |= LEFT;
-
-  if (keyboardState[SDL_SCANCODE_RIGHT])
-    input |= RIGHT;
-
-  if (keyboardState[SDL_SCANCODE_UP])
-    input |= UP;
+Byte InputHandler::getButtons() const {
+  return input;
+}
 
-  if (keyboardState[SDL_SCANCODE_DOWN])
-    input |= DOWN;
+void InputHandler::setButtons(Byte buttons) {
+  input = buttons;
 }
 
 bool InputHandler::readInput() {
@@ -83,28 +21,28 @@ bool InputHandler::readInput() {
 
   switch (readState % 8) {
     case 0:
-      res = input & A;
+      res = input & Button::A;
       break;
     case 1:
-      res = input & B;
+      res = input & Button::B;
       break;
     case 2:
-      res = input & SELECT;
+      res = input & Button::SELECT;
       break;
     case 3:
-      res = input & START;
+      res = input & Button::START;
       break;
     case 4:
-      res = input & UP;
+      res = input & Button::UP;
       break;
     case 5:
-      res = input & DOWN;
+      res = input & Button::DOWN;
       break;
     case 6:
-      res = input & LEFT;
+      res = input & Button::LEFT;
       break;
     case 7:
-      res = input & RIGHT;
+      res = input & Button::RIGHT;
       break;
   }
 
@@ -123,4 +61,4 @@ void InputHandler::startPollInput() {
 
 void InputHandler::endPollInput() {
   poll = false;
-}
\ No newline at end of file
+}
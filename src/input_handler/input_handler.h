@@ -2,16 +2,31 @@
 #define NESEMULATOR_INPUT_HANDLER_H
 
 #include <cstdint>
-#include <SDL.h>
 
 typedef uint8_t Byte;
 
+namespace Button {
+  inline constexpr Byte A        = 0b0000'0001;
+  inline constexpr Byte B        = 0b0000'0010;
+  inline constexpr Byte SELECT   = 0b0000'0100;
+  inline constexpr Byte START    = 0b0000'1000;
+  inline constexpr Byte UP       = 0b0001'0000;
+  inline constexpr Byte DOWN     = 0b0010'0000;
+  inline constexpr Byte LEFT     = 0b0100'0000;
+  inline constexpr Byte RIGHT    = 0b1000'0000;
+}
+
 class InputHandler {
 public:
   InputHandler();
 
-  void handleEvent(SDL_Event& event);
-  void handleKeyboardState();
+  void pressButton(Byte button);
+
+  /**
+   * \brief Get or replace every pressed button at once, Button values or'ed together
+   */
+  [[nodiscard]] Byte getButtons() const;
+  void setButtons(Byte buttons);
   bool readInput();
   void resetRead();
   void startPollInput();
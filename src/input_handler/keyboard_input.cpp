@@ -0,0 +1,68 @@
+#include "keyboard_input.h"
+
+KeyboardInput::KeyboardInput(InputHandler& inputHandler) : inputHandler{inputHandler} {}
+
+void KeyboardInput::handleEvent(SDL_Event& event) {
+  // TODO: Implement polling input
+
+  // Only handle keydown event
+  if (event.type == SDL_KEYUP)
+    return;
+
+  switch (event.key.keysym.sym) {
+    case SDLK_a:
+      inputHandler.pressButton(Button::A);
+      break;
+    case SDLK_b:
+      inputHandler.pressButton(Button::B);
+      break;
+    case SDLK_q:
+      inputHandler.pressButton(Button::SELECT);
+      break;
+    case SDLK_e:
+      inputHandler.pressButton(Button::START);
+      break;
+    case SDLK_UP:
+      inputHandler.pressButton(Button::UP);
+      break;
+    case SDLK_DOWN:
+      inputHandler.pressButton(Button::DOWN);
+      break;
+    case SDLK_LEFT:
+      inputHandler.pressButton(Button::LEFT);
+      break;
+    case SDLK_RIGHT:
+      inputHandler.pressButton(Button::RIGHT);
+      break;
+    default:
+      break;
+  }
+}
+
+void KeyboardInput::handleKeyboardState() {
+  const Byte* keyboardState{SDL_GetKeyboardState(nullptr) };
+
+  if (keyboardState[SDL_SCANCODE_Q])
+    inputHandler.pressButton(Button::SELECT);
+
+  if (keyboardState[SDL_SCANCODE_E])
+    inputHandler.pressButton(Button::START);
+
+  if (keyboardState[SDL_SCANCODE_A])
+    inputHandler.pressButton(Button::A);
+
+  if (keyboardState[SDL_SCANCODE_B])
+    inputHandler.pressButton(Button::B);
+
+  if (keyboardState[SDL_SCANCODE_LEFT])
+    inputHandler.pressButton(Button::LEFT);
+
+  if (keyboardState[SDL_SCANCODE_RIGHT])
+    inputHandler.pressButton(Button::RIGHT);
+
+  if (keyboardState[SDL_SCANCODE_UP])
+    inputHandler.pressButton(Button::UP);
+
+  if (keyboardState[SDL_SCANCODE_DOWN])
+    inputHandler.pressButton(Button::DOWN);
+}
@@ -0,0 +1,21 @@
+#ifndef NESEMULATOR_KEYBOARD_INPUT_H
+#define NESEMULATOR_KEYBOARD_INPUT_H
+
+#include "input_handler.h"
+#include <SDL.h>
+
+/**
+ * \brief Translate SDL keyboard events and state into controller buttons of an InputHandler
+ */
+class KeyboardInput {
+public:
+  explicit KeyboardInput(InputHandler& inputHandler);
+
+  void handleEvent(SDL_Event& event);
+  void handleKeyboardState();
+
+private:
+  InputHandler& inputHandler;
+};
+
+#endif
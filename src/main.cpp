@@ -2,18 +2,29 @@
 #include <SDL.h>
 #include <SDL_image.h>
 #include <SDL_ttf.h>
+#include <algorithm>
 #include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include <fstream>
+#include <string>
 
 #include "constants.h"
 #include "./display/display.h"
+#include "display/palette.h"
 #include "utils.h"
 #include "ppu/ppu.h"
 #include "cpu/cpu.h"
 #include "initializer/initializer.h"
 #include "display/debug_display.h"
+#include "input_handler/keyboard_input.h"
+#include "stats/host_stats.h"
+#include "frame_pacer/frame_pacer.h"
+#include "threading/emulation_thread.h"
+#include "display/triple_buffer_sink.h"
+#include "display/null_sink.h"
 
 
 int main(int argv, char** args) {
@@ -60,8 +71,29 @@ int main(int argv, char** args) {
   }
   SDL_SetWindowIcon(window, nesIcon);
 
+  // --vsync presents in step with the display refresh, --no-pacing runs as fast as possible
+  // --turbo runs in fast forward from the start, --present-every <n> presents every nth frame in fast forward
+  // instead of at most 60 frames a second
+  PacingMode pacingMode{ PacingMode::TIMER };
+  bool isTurbo{false};
+  int presentEvery{};
+  for (int i{ 1 }; i < argv; i++) {
+    if (std::string{args[i]} == "--vsync")
+      pacingMode = PacingMode::VSYNC;
+    else if (std::string{args[i]} == "--no-pacing")
+      pacingMode = PacingMode::NONE;
+    else if (std::string{args[i]} == "--turbo")
+      isTurbo = true;
+    else if (std::string{args[i]} == "--present-every" && i + 1 < argv)
+      presentEvery = std::max(0, std::atoi(args[++i]));
+  }
+
   // Making Renderer
-  SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+  SDL_Renderer* renderer = SDL_CreateRenderer(
+    window,
+    -1,
+    SDL_RENDERER_ACCELERATED | (pacingMode == PacingMode::VSYNC ? SDL_RENDERER_PRESENTVSYNC : 0)
+  );
   if (renderer == nullptr) {
     printf("Cannot create renderer! SDL Error: %s\n", SDL_GetError());
     return -1;
@@ -79,10 +111,16 @@ int main(int argv, char** args) {
     return -1;
   }
 
+  // The PPU runs on the emulation thread and draws into frameSink, the main thread presents from it on display
   Display display{renderer, texture};
-  PPU ppu{display};
+  TripleBufferSink frameSink{};
+  PPU ppu{frameSink};
   InputHandler inputHandler{};
   CPU cpu{ppu, inputHandler};
+
+  // Keyboard input is gathered on the main thread and handed over as button states
+  InputHandler keyboardButtons{};
+  KeyboardInput keyboardInput{keyboardButtons};
   Initializer initializer{cpu, ppu};
 
   std::string res{ initializer.loadFile("../test_rom/supermariobros.nes") };
@@ -90,6 +128,19 @@ int main(int argv, char** args) {
     printf("Error: %s\n", res.c_str());
   }
 
+  // --palette <file> replaces the default palette with a 192 or 1536 byte .pal file
+  for (int i{ 1 }; i + 1 < argv; i++) {
+    if (std::string{args[i]} != "--palette")
+      continue;
+
+    Palette palette{};
+    res = palette.loadFile(args[i + 1]);
+    if (res.empty())
+      display.setPalette(palette);
+    else
+      printf("Error: %s\n", res.c_str());
+  }
+
   // Debug Screen
   SDL_Window* debugWindow = SDL_CreateWindow(
     "Debug",
@@ -122,15 +173,34 @@ int main(int argv, char** args) {
     return -1;
   }
 
-  DebugDisplay debugDisplay{ppu, debugRenderer, debugTexture};
+  // The debug window shows a copy of the PPU loaded from the state the emulation thread publishes
+  NullSink debugSink{};
+  PPU debugPPU{debugSink};
+  DebugDisplay debugDisplay{debugPPU, debugRenderer, debugTexture};
 
   // freopen("log.txt", "w", stdout);
 
 
   cpu.executeStartUpSequence();
 
+  // Presenting, the debug window and events, the emulation thread counts its own host time
+  HostStats hostStats{};
+
+  // With --vsync only presenting waits for the display, the emulation thread keeps to its timer
+  const PacingMode emulationPacing{ pacingMode == PacingMode::NONE ? PacingMode::NONE : PacingMode::TIMER };
+  EmulationThread emulation{cpu, ppu, inputHandler, emulationPacing, presentEvery};
+  emulation.setDebugStateEnabled(true);
+  emulation.start();
+
+  // Tab held fast forwards, running as fast as possible and only drawing and presenting the frames FastForward picks
+  bool wasFastForward{false};
+  Byte lastButtons{};
+
+  // P pauses, losing focus to another application does too. Paused, the loop sleeps in SDL_WaitEventTimeout
+  bool isPaused{false};
+  bool isFocused{true};
+
   bool quit{false};
-  uint64_t lastTotalCycle{cpu.totalCycle};
   SDL_Event e;
 //
 //  while (!quit) {
@@ -149,21 +219,30 @@ int main(int argv, char** args) {
 //  }
 
   while (!quit) {
-    auto start{ std::chrono::system_clock::now() };
+    keyboardButtons.resetRead();
+    const bool isFastForward{ isTurbo || SDL_GetKeyboardState(nullptr)[SDL_SCANCODE_TAB] };
 
-    inputHandler.resetRead();
+    // Handle Event, waiting a little for one so the loop does not spin between frames
+    hostStats.enter(Subsystem::EVENTS);
+    const bool wasIdle{ isPaused || !isFocused };
+    bool hasEvent{ SDL_WaitEventTimeout(&e, wasIdle ? 100 : 1) == 1 };
+    for (; hasEvent; hasEvent = SDL_PollEvent(&e) == 1) {
+      keyboardInput.handleEvent(e);
 
-    debugDisplay.updateScreen();
+      if (e.key.keysym.sym == SDLK_p && e.type == SDL_KEYDOWN && e.key.repeat == 0)
+        isPaused = !isPaused;
 
-    // Handle Event
-    while (SDL_PollEvent(&e)) {
-      inputHandler.handleEvent(e);
+      // Moving focus between the main and the debug window loses it before gaining it
+      if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_FOCUS_GAINED)
+        isFocused = true;
+      if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_FOCUS_LOST)
+        isFocused = false;
 
       if (e.key.keysym.sym == SDLK_0 && e.type == SDL_KEYDOWN) {
         for (int i{0x2000}; i < 0x23C0; i++) {
           if (i % 0x20 == 0)
             printf("\n");
-          printf("%02X ", ppu.memory[i]);
+          printf("%02X ", debugPPU.memory[i]);
         }
 
         printf("\n");
@@ -171,54 +250,84 @@ int main(int argv, char** args) {
         for (int i{0x23C0}; i < 0x2400; i++) {
           if (i % 0x08 == 0)
             printf("\n");
-          printf("%02X ", ppu.memory[i]);
+          printf("%02X ", debugPPU.memory[i]);
         }
 
         printf("\n");
-//
-//        for (int i{}; i < 256; i++) {
-//          if (i % 0x10 == 0)
-//            printf("\n");
-//          printf("%02X ", ppu.oam[i]);
-//        }
       }
 
-      if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_CLOSE) {
+      if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_CLOSE)
         quit = true;
+    }
 
-        // Destroy SDL Stuff
-        SDL_DestroyWindow(window);
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyTexture(texture);
-
-        SDL_DestroyWindow(debugWindow);
-        SDL_DestroyRenderer(debugRenderer);
-        SDL_DestroyTexture(debugTexture);
+    if (quit) {
+      hostStats.leave();
+      break;
+    }
 
-        window = nullptr;
-        SDL_Quit();
-      }
+    emulation.setPaused(isPaused || !isFocused);
+    if (isPaused || !isFocused) {
+      hostStats.leave();
+      continue;
     }
 
-    // Handle Keyboard State
-    inputHandler.handleKeyboardState();
+    // Handle Keyboard State, only changes are queued so every one of them lasts at least a frame
+    keyboardInput.handleKeyboardState();
+    if (keyboardButtons.getButtons() != lastButtons && emulation.pushInput(keyboardButtons.getButtons()))
+      lastButtons = keyboardButtons.getButtons();
+
+    emulation.setFastForward(isFastForward);
+    if (isFastForward) {
+      char title[64];
+      snprintf(title, sizeof(title), "NES Emulator - Fast Forward %.1fx", emulation.getFastForwardSpeed());
+      SDL_SetWindowTitle(window, title);
+    } else if (wasFastForward) {
+      SDL_SetWindowTitle(window, "NES Emulator");
+    }
+    wasFastForward = isFastForward;
+    hostStats.leave();
 
-    // Execute CPU
-    while (true) {
-      cpu.executeNextClock();
-      if ((cpu.totalCycle - lastTotalCycle) > 29833) {
-        lastTotalCycle = cpu.totalCycle;
-        break;
+    if (frameSink.acquireFrame()) {
+      {
+        HostStats::Scope scope{&hostStats, Subsystem::DISPLAY};
+        display.presentFrame(frameSink.getFrame().data());
       }
     }
 
-    using namespace std::chrono_literals;
-
-    // std::this_thread::sleep_until(start + 15.6ms);
-
-    auto end{ std::chrono::system_clock::now() };
-    // printf("%lld\n", std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+    // Published along with the frames presented, it may come in just after the frame itself
+    if (emulation.acquireDebugState() && debugPPU.loadState(emulation.getDebugState())) {
+      HostStats::Scope scope{&hostStats, Subsystem::DEBUG_DISPLAY};
+      debugDisplay.updateScreen();
+    }
   }
 
+  emulation.stop();
+
+  // Destroy SDL Stuff
+  SDL_DestroyTexture(texture);
+  SDL_DestroyRenderer(renderer);
+  SDL_DestroyWindow(window);
+
+  SDL_DestroyTexture(debugTexture);
+  SDL_DestroyRenderer(debugRenderer);
+  SDL_DestroyWindow(debugWindow);
+
+  window = nullptr;
+  SDL_Quit();
+
+  const HostStats& emulationStats{ emulation.getHostStats() };
+  printf("%llu frames, frame time p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, %.1f fps, %.2fx real time\n",
+         static_cast<unsigned long long>(emulationStats.getFrameCount()), emulationStats.getFrameTimePercentile(50),
+         emulationStats.getFrameTimePercentile(95), emulationStats.getFrameTimePercentile(99),
+         emulationStats.getEmulatedFPS(), emulationStats.getSpeed());
+  printf("%llu missed deadlines, drift mean %.3f ms, max %.3f ms\n",
+         static_cast<unsigned long long>(emulationStats.getMissedDeadlines()), emulationStats.getMeanDrift(),
+         emulationStats.getMaxDrift());
+  printf("main thread: display %.3f s, debug display %.3f s, events %.3f s\n",
+         hostStats.getNanoseconds(Subsystem::DISPLAY) / 1e9, hostStats.getNanoseconds(Subsystem::DEBUG_DISPLAY) / 1e9,
+         hostStats.getNanoseconds(Subsystem::EVENTS) / 1e9);
+  std::ofstream statsFile{"host_stats.json"};
+  emulationStats.writeJSON(statsFile);
+
   return 0;
 }
@@ -0,0 +1,165 @@
+#include "compose.h"
+#include "../simd.h"
+
+#ifdef NES_SIMD_X86
+#include <immintrin.h>
+#endif
+
+// A background pixel is opaque if background rendering is on, its pixel value is not 0 and it is not in the left
+// 8 columns while those are hidden, likewise for a sprite pixel. The sprite wins over the background if it is
+// opaque and either in front (bit 6 clear) or over a transparent background pixel
+
+bool composeLineScalar(const Byte* background, const Byte* sprites, const Byte* palette, Byte ppuMask, Byte* out) {
+  const bool showBackground{ (ppuMask & 0b1000) != 0 };
+  const bool showSprites{ (ppuMask & 0b1'0000) != 0 };
+  bool sprite0Hit{};
+
+  for (int column{}; column < EmuConst::SCREEN_WIDTH; column++) {
+    const Byte bg{ background[column] };
+    const Byte sprite{ sprites[column] };
+
+    const bool bgOpaque{ showBackground && (bg & 0b11) && (column >= 8 || (ppuMask & 0b0010)) };
+    const bool spriteOpaque{ showSprites && (sprite & 0b11) && (column >= 8 || (ppuMask & 0b0100)) };
+
+    if (bgOpaque && spriteOpaque && (sprite & 0b0010'0000))
+      sprite0Hit = true;
+
+    Byte colorMemAddr{};
+    if (spriteOpaque && (!bgOpaque || !(sprite & 0b0100'0000)))
+      colorMemAddr = sprite & 0x1F;
+    else if (bgOpaque)
+      colorMemAddr = bg & 0x1F;
+    out[column] = palette[colorMemAddr];
+  }
+
+  return sprite0Hit;
+}
+
+#ifdef NES_SIMD_X86
+NES_TARGET_SSE2
+bool composeLineSSE2(const Byte* background, const Byte* sprites, const Byte* palette, Byte ppuMask, Byte* out) {
+  const __m128i zero{ _mm_setzero_si128() };
+  const __m128i pixelValueMask{ _mm_set1_epi8(0b11) };
+  const __m128i sprite0Mask{ _mm_set1_epi8(0b0010'0000) };
+  const __m128i priorityMask{ _mm_set1_epi8(0b0100'0000) };
+  const __m128i colorMask{ _mm_set1_epi8(0x1F) };
+  const __m128i leftColumns{ _mm_set_epi64x(0, -1) };
+
+  const __m128i showBackground{ ppuMask & 0b1000 ? _mm_set1_epi8(-1) : zero };
+  const __m128i showSprites{ ppuMask & 0b1'0000 ? _mm_set1_epi8(-1) : zero };
+  const __m128i hideBackgroundLeft{ ppuMask & 0b0010 ? zero : leftColumns };
+  const __m128i hideSpritesLeft{ ppuMask & 0b0100 ? zero : leftColumns };
+
+  alignas(16) Byte colorMemAddr[EmuConst::SCREEN_WIDTH];
+  __m128i hits{ zero };
+  for (int column{}; column < EmuConst::SCREEN_WIDTH; column += 16) {
+    const __m128i bg{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(background + column)) };
+    const __m128i sprite{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(sprites + column)) };
+
+    __m128i bgOpaque{ _mm_andnot_si128(_mm_cmpeq_epi8(_mm_and_si128(bg, pixelValueMask), zero), showBackground) };
+    __m128i spriteOpaque{ _mm_andnot_si128(_mm_cmpeq_epi8(_mm_and_si128(sprite, pixelValueMask), zero), showSprites) };
+    if (column == 0) {
+      bgOpaque = _mm_andnot_si128(hideBackgroundLeft, bgOpaque);
+      spriteOpaque = _mm_andnot_si128(hideSpritesLeft, spriteOpaque);
+    }
+
+    const __m128i overlap{ _mm_and_si128(bgOpaque, spriteOpaque) };
+    hits = _mm_or_si128(hits, _mm_and_si128(overlap, sprite));
+
+    const __m128i behind{ _mm_cmpeq_epi8(_mm_and_si128(sprite, priorityMask), priorityMask) };
+    const __m128i useSprite{ _mm_andnot_si128(_mm_and_si128(bgOpaque, behind), spriteOpaque) };
+    const __m128i result{
+      _mm_or_si128(_mm_and_si128(useSprite, sprite), _mm_andnot_si128(useSprite, _mm_and_si128(bgOpaque, bg)))
+    };
+    _mm_store_si128(reinterpret_cast<__m128i*>(colorMemAddr + column), _mm_and_si128(result, colorMask));
+  }
+
+  // SSE2 has no byte shuffle, the palette is read one pixel at a time
+  for (int column{}; column < EmuConst::SCREEN_WIDTH; column++)
+    out[column] = palette[colorMemAddr[column]];
+
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(hits, sprite0Mask), zero)) != 0xFFFF;
+}
+
+NES_TARGET_AVX2
+bool composeLineAVX2(const Byte* background, const Byte* sprites, const Byte* palette, Byte ppuMask, Byte* out) {
+  const __m256i zero{ _mm256_setzero_si256() };
+  const __m256i pixelValueMask{ _mm256_set1_epi8(0b11) };
+  const __m256i sprite0Mask{ _mm256_set1_epi8(0b0010'0000) };
+  const __m256i priorityMask{ _mm256_set1_epi8(0b0100'0000) };
+  const __m256i highPaletteMask{ _mm256_set1_epi8(0x10) };
+  const __m256i colorMask{ _mm256_set1_epi8(0x0F) };
+  const __m256i leftColumns{ _mm256_set_epi64x(0, 0, 0, -1) };
+
+  const __m256i showBackground{ ppuMask & 0b1000 ? _mm256_set1_epi8(-1) : zero };
+  const __m256i showSprites{ ppuMask & 0b1'0000 ? _mm256_set1_epi8(-1) : zero };
+  const __m256i hideBackgroundLeft{ ppuMask & 0b0010 ? zero : leftColumns };
+  const __m256i hideSpritesLeft{ ppuMask & 0b0100 ? zero : leftColumns };
+
+  // Both halves of the palette in both 128-bit lanes, as vpshufb only shuffles within a lane
+  const __m256i lowPalette{
+    _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(palette)))
+  };
+  const __m256i highPalette{
+    _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(palette + 16)))
+  };
+
+  __m256i hits{ zero };
+  for (int column{}; column < EmuConst::SCREEN_WIDTH; column += 32) {
+    const __m256i bg{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(background + column)) };
+    const __m256i sprite{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sprites + column)) };
+
+    __m256i bgOpaque{
+      _mm256_andnot_si256(_mm256_cmpeq_epi8(_mm256_and_si256(bg, pixelValueMask), zero), showBackground)
+    };
+    __m256i spriteOpaque{
+      _mm256_andnot_si256(_mm256_cmpeq_epi8(_mm256_and_si256(sprite, pixelValueMask), zero), showSprites)
+    };
+    if (column == 0) {
+      bgOpaque = _mm256_andnot_si256(hideBackgroundLeft, bgOpaque);
+      spriteOpaque = _mm256_andnot_si256(hideSpritesLeft, spriteOpaque);
+    }
+
+    const __m256i overlap{ _mm256_and_si256(bgOpaque, spriteOpaque) };
+    hits = _mm256_or_si256(hits, _mm256_and_si256(overlap, sprite));
+
+    const __m256i behind{ _mm256_cmpeq_epi8(_mm256_and_si256(sprite, priorityMask), priorityMask) };
+    const __m256i useSprite{ _mm256_andnot_si256(_mm256_and_si256(bgOpaque, behind), spriteOpaque) };
+    const __m256i colorMemAddr{
+      _mm256_blendv_epi8(_mm256_and_si256(bgOpaque, bg), sprite, useSprite)
+    };
+
+    // Bit 4 picks the sprite half of the palette, bits 0 to 3 the entry inside it. vpshufb only uses those 4 bits
+    // as long as bit 7 is clear, which the mask makes sure of
+    const __m256i entry{ _mm256_and_si256(colorMemAddr, colorMask) };
+    const __m256i isHigh{
+      _mm256_cmpeq_epi8(_mm256_and_si256(colorMemAddr, highPaletteMask), highPaletteMask)
+    };
+    const __m256i color{
+      _mm256_blendv_epi8(_mm256_shuffle_epi8(lowPalette, entry), _mm256_shuffle_epi8(highPalette, entry), isHigh)
+    };
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + column), color);
+  }
+
+  return !_mm256_testz_si256(hits, sprite0Mask);
+}
+#else
+bool composeLineSSE2(const Byte* background, const Byte* sprites, const Byte* palette, Byte ppuMask, Byte* out) {
+  return composeLineScalar(background, sprites, palette, ppuMask, out);
+}
+
+bool composeLineAVX2(const Byte* background, const Byte* sprites, const Byte* palette, Byte ppuMask, Byte* out) {
+  return composeLineScalar(background, sprites, palette, ppuMask, out);
+}
+#endif
+
+bool composeLine(const Byte* background, const Byte* sprites, const Byte* palette, Byte ppuMask, Byte* out) {
+  switch (getSimdLevel()) {
+    case SimdLevel::AVX2:
+      return composeLineAVX2(background, sprites, palette, ppuMask, out);
+    case SimdLevel::SSE2:
+      return composeLineSSE2(background, sprites, palette, ppuMask, out);
+    default:
+      return composeLineScalar(background, sprites, palette, ppuMask, out);
+  }
+}
@@ -0,0 +1,22 @@
+#ifndef NESEMULATOR_COMPOSE_H
+#define NESEMULATOR_COMPOSE_H
+
+#include "../constants.h"
+
+/**
+ * \brief Merge a line of background and sprite pixels into colour indices, PPU::composePixel() for a whole line
+ * \param background SCREEN_WIDTH background PixelData, column 0 first
+ * \param sprites SCREEN_WIDTH sprite PixelData, column 0 first
+ * \param palette the 32 entries of palette memory ($3F00 - $3F1F), greyscale already applied
+ * \param ppuMask the PPUMASK value for the whole line
+ * \param out SCREEN_WIDTH colour indices read from palette
+ * \return true if an opaque sprite 0 pixel overlapped an opaque background pixel, i.e. sprite 0 hit
+ * \note Runs the kernel of getSimdLevel(), every kernel gives the same result
+ */
+bool composeLine(const Byte* background, const Byte* sprites, const Byte* palette, Byte ppuMask, Byte* out);
+
+bool composeLineScalar(const Byte* background, const Byte* sprites, const Byte* palette, Byte ppuMask, Byte* out);
+bool composeLineSSE2(const Byte* background, const Byte* sprites, const Byte* palette, Byte ppuMask, Byte* out);
+bool composeLineAVX2(const Byte* background, const Byte* sprites, const Byte* palette, Byte ppuMask, Byte* out);
+
+#endif
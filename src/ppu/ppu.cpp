@@ -1,19 +1,36 @@
 #include "ppu.h"
 #include "../utils.h"
+#include "compose.h"
+#include "render_pipeline.h"
 #include <cstdio>
-
-Background::Background(PPU &ppu) : ppu{ppu}, v{ppu.v} {}
-
-void Background::clearDeque() {
-  backgroundPixelData.clear();
+#include <cstring>
+#include <algorithm>
+
+Background::Background(PPU &ppu) : ppu{ppu}, v{ppu.v}, patternLow{}, patternHigh{}, attributeLow{}, attributeHigh{},
+queuedPixels{} {}
+
+void Background::clearShifters() {
+  patternLow = 0;
+  patternHigh = 0;
+  attributeLow = 0;
+  attributeHigh = 0;
+  queuedPixels = 0;
 }
 
 PixelData Background::getPixelData() {
-  if (backgroundPixelData.empty())
+  if (queuedPixels == 0)
     return 0;
 
-  const PixelData temp{ backgroundPixelData[ppu.x] };
-  backgroundPixelData.pop_front();
+  const int bit{ 15 - ppu.x };
+  const PixelData temp{
+    static_cast<PixelData>(((patternLow >> bit) & 1) | (((patternHigh >> bit) & 1) << 1) |
+                           (((attributeLow >> bit) & 1) << 2) | (((attributeHigh >> bit) & 1) << 3))
+  };
+  patternLow <<= 1;
+  patternHigh <<= 1;
+  attributeLow <<= 1;
+  attributeHigh <<= 1;
+  queuedPixels--;
   return temp;
 }
 
@@ -24,16 +41,55 @@ void Background::tick() {
   if (ppu.cycle % 8 != 0)
     return;
 
-  Byte nameTableByte;
-  Byte ptrnTableLow;
-  Byte ptrnTableHigh;
-  Byte attr;
+  loadTile(fetchTile());
+
+  // At the end clear shifters and update v
+  if (ppu.cycle == 256) {
+    incrementY();
+    clearShifters();
+  }
+}
+
+bool Background::canRenderScanline() const {
+  return queuedPixels == 16;
+}
+
+void Background::renderScanline(PixelData* line) {
+  // Each cycle shifts one pixel out and each 8th cycle loads a tile, so with the 2 prefetched tiles loaded the
+  // pixel drawn at x is always pixel x + fine x of the prefetched tiles followed by this line's tiles
+  for (int i{}; i < 16; i++) {
+    const int bit{ 15 - i };
+    line[i] = ((patternLow >> bit) & 1) | (((patternHigh >> bit) & 1) << 1) |
+              (((attributeLow >> bit) & 1) << 2) | (((attributeHigh >> bit) & 1) << 3);
+  }
+
+  for (int tile{}; tile < 32; tile++)
+    decodeTile(fetchTile(), line + 16 + tile * 8);
+
+  incrementY();
+  clearShifters();
+}
+
+void Background::skipScanline() {
+  // The 32 coarse X increments of the line bring coarse X back where it was, crossing into the other name table once
+  v ^= 0x0400;
+
+  incrementY();
+  clearShifters();
+}
+
+void Background::prefetchTiles() {
+  loadTile(fetchTile());
+  loadTile(fetchTile());
+}
+
+Background::Tile Background::fetchTile() {
+  Tile tile{};
   int attrOffset;
 
-  nameTableByte = ppu.readMemory(0x2000 | (v & 0x0FFF));
-  attr = ppu.readMemory(0x23C0 | (v & 0x0C00) | ((v >> 4) & 0x38) | ((v >> 2) & 0x07));
-  ptrnTableLow = ppu.readMemory(((ppu.ppuCtrl & 0b10000) << 8) | (nameTableByte << 4) | ((v & 0x7000) >> 12));
-  ptrnTableHigh = ppu.readMemory(((ppu.ppuCtrl & 0b10000) << 8) | (nameTableByte << 4) | 0b1000 | ((v & 0x7000) >> 12));
+  const Byte nameTableByte{ ppu.readMemory(0x2000 | (v & 0x0FFF)) };
+  tile.attribute = ppu.readMemory(0x23C0 | (v & 0x0C00) | ((v >> 4) & 0x38) | ((v >> 2) & 0x07));
+  tile.patternAddr = ((ppu.ppuCtrl & 0b10000) << 8) | (nameTableByte << 4) | ((v & 0x7000) >> 12);
 
   int offsetX{ v % 4 };
   int offsetY{ (v / 32) % 4 };
@@ -42,13 +98,7 @@ void Background::tick() {
   else
     attrOffset = offsetX < 2 ? 4 : 6;
 
-  attr = (attr & (0b11 << attrOffset)) >> attrOffset;
-
-  for (int i{}; i < 8; i++) {
-    backgroundPixelData.emplace_back((attr << 2) | (((ptrnTableLow & 0x80) >> 7) + ((ptrnTableHigh & 0x80) >> 7) * 2));
-    ptrnTableLow <<= 1;
-    ptrnTableHigh <<= 1;
-  }
+  tile.attribute = (tile.attribute & (0b11 << attrOffset)) >> attrOffset;
 
   // Switch to new NameTable
   if ((v & 0b11111) == 31) {
@@ -58,34 +108,54 @@ void Background::tick() {
     v++;
   }
 
-  // At the end clear queue and update v
-  if (ppu.cycle == 256) {
-    if ((v & 0x7000) != 0x7000) {
-      v += 0x1000;
+  return tile;
+}
+
+void Background::loadTile(const Tile& tile) {
+  const Byte ptrnTableLow{ ppu.readMemory(tile.patternAddr) };
+  const Byte ptrnTableHigh{ ppu.readMemory(tile.patternAddr | 0b1000) };
+
+  // The tile goes right after the queued pixels, anything past the 16 bits of the shifters is dropped
+  const int shift{ 8 - queuedPixels };
+  const auto place = [shift](Word bits) -> Word { return shift >= 0 ? bits << shift : bits >> -shift; };
+  patternLow |= place(ptrnTableLow);
+  patternHigh |= place(ptrnTableHigh);
+  attributeLow |= place(tile.attribute & 0b01 ? 0xFF : 0x00);
+  attributeHigh |= place(tile.attribute & 0b10 ? 0xFF : 0x00);
+  queuedPixels = std::min(queuedPixels + 8, 16);
+}
+
+void Background::decodeTile(const Tile& tile, PixelData* pixels) {
+  // The palette bits are the same for the 8 pixels, so they are added to all of them at once
+  const uint64_t row{ ppu.tileCache.getRowBits(tile.patternAddr >> 4, tile.patternAddr & 0b111, false) };
+  const uint64_t pixelBits{ row | (tile.attribute << 2) * 0x0101'0101'0101'0101ull };
+  std::memcpy(pixels, &pixelBits, 8);
+}
+
+void Background::incrementY() {
+  if ((v & 0x7000) != 0x7000) {
+    v += 0x1000;
+  } else {
+    v &= 0x8FFF;
+
+    Byte coarseY{static_cast<Byte>((v & 0x3E0) >> 5) };
+    if (coarseY == 29) {
+      coarseY = 0;
+      v ^= 0x0800;
+    } else if (coarseY == 31) {
+      coarseY = 0;
     } else {
-      v &= 0x8FFF;
-
-      Byte coarseY{static_cast<Byte>((v & 0x3E0) >> 5) };
-      if (coarseY == 29) {
-        coarseY = 0;
-        v ^= 0x0800;
-      } else if (coarseY == 31) {
-        coarseY = 0;
-      } else {
-        coarseY += 1;
-      }
-      v = (v & ~0x03E0) | (coarseY << 5);
+      coarseY += 1;
     }
-
-    backgroundPixelData.clear();
+    v = (v & ~0x03E0) | (coarseY << 5);
   }
 }
 
 
 
 OAM::OAM(PPU& ppu) : ppu{ppu}, oam(0x100, 0xFF), secondaryOam(0x20, 0xFF),
-spritePixelData(EmuConst::SCREEN_WIDTH), oamAddr{}, isSecondaryOamClearing{}, secondaryOamAddr{},
-spriteEvaluationEnd{}, readOffset{} {}
+spritePixelData(EmuConst::SCREEN_WIDTH), oamAddr{}, secondaryOamAddr{}, spriteEvaluationEnd{}, readOffset{},
+isSecondaryOamClearing{}, spriteTable{}, spriteTableHeight{}, midFrameWriteFrame{-2} {}
 
 Byte OAM::getPixelData(int x) {
   Byte temp{ spritePixelData[x] };
@@ -93,6 +163,11 @@ Byte OAM::getPixelData(int x) {
   return temp;
 }
 
+void OAM::takeLinePixelData(PixelData* line) {
+  std::copy(spritePixelData.begin(), spritePixelData.end(), line);
+  std::fill(spritePixelData.begin(), spritePixelData.end(), 0);
+}
+
 void OAM::writeOAMAddr(Byte input) {
   oamAddr = input;
 }
@@ -104,14 +179,16 @@ Byte OAM::readOAMData() {
 void OAM::writeOAMData(Byte input) {
   oam[oamAddr] = oamAddr % 4 == 2 ? input & 0b1110'0011 : input;
   oamAddr++;
+  invalidateSpriteTable();
 }
 
-void OAM::DMA(std::vector<Byte>& cpuMem, Byte input) {
+void OAM::DMA(const Byte* page) {
   Byte writeAddr{ oamAddr };
-  for (int i{ input * 256 }; i <= input * 256 + 255; i++) {
-    oam[writeAddr] = cpuMem[i];
+  for (int i{}; i < 256; i++) {
+    oam[writeAddr] = page[i];
     writeAddr++;
   }
+  invalidateSpriteTable();
 }
 
 void OAM::tick() {
@@ -126,7 +203,7 @@ void OAM::tick() {
       if (ppu.cycle == 1)
         isSecondaryOamClearing = true;
 
-      secondaryOam[ppu.cycle / 2 - 1] = readOAMData();
+      secondaryOam[(ppu.cycle - 1) / 2] = readOAMData();
 
       if (ppu.cycle == 64) {
         isSecondaryOamClearing = false;
@@ -153,12 +230,32 @@ void OAM::tick() {
   }
 }
 
+void OAM::renderScanline() {
+  // Cycle 1 to 64
+  std::fill(secondaryOam.begin(), secondaryOam.end(), 0xFF);
+  isSecondaryOamClearing = false;
+  spriteEvaluationEnd = false;
+  secondaryOamAddr = 0;
+  readOffset = 0;
+
+  // Cycle 65 to 256
+  if (!evaluateFromSpriteTable()) {
+    for (int cycle{65}; cycle <= 256 && !spriteEvaluationEnd; cycle++)
+      evaluateOAM();
+  }
+
+  // Cycle 257 to 320
+  oamAddr = 0;
+  for (int index{}; index < 8; index++)
+    evaluateSpriteData(index);
+}
+
 void OAM::evaluateOAM() {
   const Byte current{ oam[oamAddr] };
 
   if (secondaryOamAddr == 32) { // Sprite Overflow Process
     // Current scanline is in range of sprite
-    if (current <= ppu.scanline && ppu.scanline < oam[oamAddr + readOffset] + (((ppu.ppuCtrl & 0b0010'0000) >> 5) + 1) * 8) {
+    if (current <= ppu.scanline && ppu.scanline < oam[(oamAddr + readOffset) & 0xFF] + (((ppu.ppuCtrl & 0b0010'0000) >> 5) + 1) * 8) {
       ppu.ppuStatus |= 0b0010'0000;
       readOffset += 4;
       if (readOffset >= 4) {
@@ -185,7 +282,54 @@ void OAM::evaluateOAM() {
     }
 
     oamAddr += 4;
+
+    // All 64 sprites have been evaluated
+    if (oamAddr == 0)
+      spriteEvaluationEnd = true;
+  }
+}
+
+bool OAM::evaluateFromSpriteTable() {
+  if (oamAddr != 0 || midFrameWriteFrame == ppu.frame)
+    return false;
+
+  const int height{ (((ppu.ppuCtrl & 0b0010'0000) >> 5) + 1) * 8 };
+  if (spriteTableHeight != height)
+    buildSpriteTable(height);
+
+  const ScanlineSprites& sprites{ spriteTable[ppu.scanline] };
+  if (sprites.count == 8)
+    return false;
+
+  for (int i{}; i < sprites.count; i++)
+    std::copy_n(&oam[sprites.indices[i] * 4], 4, &secondaryOam[i * 4]);
+
+  // Same state as evaluateOAM() leaves after going through all 64 sprites from OAMADDR 0
+  secondaryOamAddr = sprites.count * 4;
+  spriteEvaluationEnd = true;
+  return true;
+}
+
+void OAM::buildSpriteTable(int height) {
+  for (ScanlineSprites& sprites : spriteTable)
+    sprites.count = 0;
+
+  for (int index{}; index < 64; index++) {
+    const int yPos{ oam[index * 4] };
+    for (int line{ yPos }; line < yPos + height && line < EmuConst::SCREEN_HEIGHT; line++) {
+      ScanlineSprites& sprites{ spriteTable[line] };
+      if (sprites.count < 8)
+        sprites.indices[sprites.count++] = index;
+    }
   }
+
+  spriteTableHeight = height;
+}
+
+void OAM::invalidateSpriteTable() {
+  spriteTableHeight = 0;
+  if (ppu.isRendering() && 0 <= ppu.scanline && ppu.scanline < EmuConst::SCREEN_HEIGHT)
+    midFrameWriteFrame = ppu.frame;
 }
 
 void OAM::evaluateSpriteData(int index) {
@@ -229,6 +373,20 @@ void OAM::evaluateSpriteData(int index) {
                    : ((ppu.ppuCtrl & 0b1000) << 9) | (patternIndex << 4) | row;
   }
 
+  const PixelData spriteBits{
+    static_cast<PixelData>(0x90 | ((attr & 0b0010'0000) << 1) | (sprite0 << 5) | 0x10 | ((attr & 0b11) << 2))
+  };
+
+  // Rows in the pattern tables come decoded from the tile cache, anything else is read plane by plane
+  if (ptrnLocation < 0x2000 && (ptrnLocation & 0b1000) == 0) {
+    const Byte* pixels{ ppu.tileCache.getRow(ptrnLocation >> 4, ptrnLocation & 0b111, attr & 0b0100'0000) };
+    for (int i{}; i < 8 && xPos + i < static_cast<int>(spritePixelData.size()); i++) {
+      if ((spritePixelData[xPos + i] & 0b11) == 0)
+        spritePixelData[xPos + i] = spriteBits | pixels[i];
+    }
+    return;
+  }
+
   ptrnTableLow = ppu.readMemory(ptrnLocation);
   ptrnTableHigh = ppu.readMemory(ptrnLocation | 0b1000);
 
@@ -239,7 +397,7 @@ void OAM::evaluateSpriteData(int index) {
         return;
 
       if ((spritePixelData[i] & 0b11) == 0)
-        spritePixelData[i] = 0x90 | ((attr & 0b0010'0000) << 1) | (sprite0 << 5) | 0x10 | ((attr & 0b11) << 2) | ((ptrnTableLow & 0b1) * 1 + (ptrnTableHigh & 0b1) * 2);
+        spritePixelData[i] = spriteBits | ((ptrnTableLow & 0b1) * 1 + (ptrnTableHigh & 0b1) * 2);
 
       ptrnTableLow >>= 1;
       ptrnTableHigh >>= 1;
@@ -247,7 +405,7 @@ void OAM::evaluateSpriteData(int index) {
   } else {
     for (int i{xPos + 7}; i >= xPos; i--) {
       if (i < spritePixelData.size() && (spritePixelData[i] & 0b11) == 0)
-        spritePixelData[i] = 0x90 | ((attr & 0b0010'0000) << 1) | (sprite0 << 5) | 0x10 | ((attr & 0b11) << 2) | ((ptrnTableLow & 0b1) * 1 + (ptrnTableHigh & 0b1) * 2);
+        spritePixelData[i] = spriteBits | ((ptrnTableLow & 0b1) * 1 + (ptrnTableHigh & 0b1) * 2);
 
       ptrnTableLow >>= 1;
       ptrnTableHigh >>= 1;
@@ -257,25 +415,31 @@ void OAM::evaluateSpriteData(int index) {
 
 
 
-PPU::PPU(Display& display) : memory(0x4000),
-ppuCtrl{}, ppuMask{}, ppuStatus{}, v{}, t{}, x{}, w{}, cycle{-1}, scanline{-1}, isEvenFrame{false},
-display{display}, first{true}, frame{-1}, disableNextNMI{false},
-nametableArrangement{}, oam{*this}, background{*this} {}
+PPU::PPU(FrameSink& sink) : memory(0x4000),
+cycle{-1}, scanline{-1}, isEvenFrame{false}, frame{-1}, clock{}, disableNextNMI{false}, v{},
+sink{sink}, tileCache{memory}, oam{*this}, background{*this}, mirroring{}, pages{},
+ppuCtrl{}, ppuMask{}, ppuStatus{}, t{}, x{}, w{}, readBuffer{}, first{true}, scheduler{}, hostStats{}, renderPipeline{},
+useScanlineRenderer{true}, renderEnabled{true}, isFrameRendered{true}, drawnFrameCount{} {
+  for (int page{}; page < 8; page++)
+    pages[page] = &memory[page * 0x400];
+  setMirroring(Mirroring::HORIZONTAL);
+}
 
 void PPU::executeNextClock() {
+  clock++;
   cycle = (cycle + 1) % 341;
   if (cycle == 0) {
     scanline = (scanline + 1) % 262;
     if (scanline == 0) {
       // Write to yScroll is ignored during rendering
-      isEvenFrame = !isEvenFrame;
-      frame += 1;
+      startFrame();
     }
   }
 
   if (first) {
     if (scanline == 241 && cycle == 1) {
       ppuStatus |= 0b1000'0000;
+      signalNMIChange();
     }
 
     if (scanline == 261 && cycle == 320) {
@@ -293,17 +457,25 @@ void PPU::executeNextClock() {
     case 241:
       if (cycle == 1) {
         if (!disableNextNMI) {
-          display.updateScreen();
-          display.clearBuffer();
+          if (isFrameRendered) {
+            HostStats::Scope scope{hostStats, Subsystem::DISPLAY};
+            sink.updateScreen();
+            drawnFrameCount++;
+          }
           ppuStatus |= 0b1000'0000;
+          signalNMIChange();
         }
         disableNextNMI = false;
+
+        if (renderPipeline)
+          renderPipeline->endFrame();
       }
     case 242 ... 260:
       break;
     case 261:
       if (cycle == 1) {
         ppuStatus = 0;
+        signalNMIChange();
       }
 
       handlePreRenderScanline();
@@ -312,79 +484,312 @@ void PPU::executeNextClock() {
       if (isRendering() && cycle == 340 && !isEvenFrame) {
         cycle = 0;
         scanline = 0;
-        isEvenFrame = !isEvenFrame;
-        frame += 1;
+        startFrame();
       }
     default:
       break;
   }
 }
 
-Word PPU::mapMemory(Word addr) const {
-  switch (addr) {
-    case 0x2000 ... 0x2FFF:
-      if (nametableArrangement) { // Vertical Mirroring
-        switch (addr) {
-          case 0x2000 ... 0x27FF:
-            addr = addr;
-            break;
-          case 0x2800 ... 0x2FFF:
-            addr -= 0x800;
-            break;
-          default:
-            printf("vertical Mirroring default encountered!\n");
-        }
-      } else { // Horizontal Mirroring
-        switch (addr) {
-          case 0x2000 ... 0x23FF:
-            addr = addr;
-            break;
-          case 0x2400 ... 0x27FF:
-            addr -= 0x400;
-            break;
-          case 0x2800 ... 0x2BFF:
-            addr = addr;
-            break;
-          case 0x2C00 ... 0x2FFF:
-            addr -= 0x400;
-            break;
-          default:
-            printf("horizontal Mirroring default encountered! @ %04X\n", addr);
-        }
-      }
-      break;
-    case 0x3F00 ... 0x3FFF:
-      switch (addr % 0x20) {
-        case 0x10:
-          addr = 0x3F00;
-          break;
-        case 0x14:
-          addr = 0x3F04;
-          break;
-        case 0x18:
-          addr = 0x3F08;
-          break;
-        case 0x1C:
-          addr = 0x3F0C;
-          break;
-        default:
-          addr = 0x3F00 + addr % 0x20;
-          break;
-      }
-      break;
+void PPU::runUntil(uint64_t targetClock) {
+  constexpr int SCANLINE_LENGTH{ 341 };
+
+  while (clock < targetClock) {
+    // Nothing happens from scanline 240 to cycle 0 of scanline 241 and from cycle 2 of scanline 241 to the end
+    // of scanline 260, so jump straight to the end of those ranges
+    int idleEnd{ -1 };
+    const int position{ getFramePosition() };
+    if (!first) {
+      if (240 * SCANLINE_LENGTH - 1 <= position && position < 241 * SCANLINE_LENGTH)
+        idleEnd = 241 * SCANLINE_LENGTH;
+      else if (241 * SCANLINE_LENGTH + 1 <= position && position < 261 * SCANLINE_LENGTH - 1)
+        idleEnd = 261 * SCANLINE_LENGTH - 1;
+    }
+
+    if (idleEnd == -1) {
+      // A register write syncs the PPU first, so when the target is past the end of a visible scanline nothing
+      // can change during it and the whole line can be rendered at once
+      if (!first && cycle == 0 && scanline < 240 && targetClock - clock >= 340 && canRenderScanline())
+        renderScanline();
+      else
+        executeNextClock();
+      continue;
+    }
+
+    const int skip{ static_cast<int>(std::min<uint64_t>(idleEnd - position, targetClock - clock)) };
+    clock += skip;
+    scanline = (position + skip) / SCANLINE_LENGTH;
+    cycle = (position + skip) % SCANLINE_LENGTH;
+  }
+
+  scheduleVBlankEvents();
+}
+
+void PPU::attachScheduler(Scheduler& newScheduler) {
+  scheduler = &newScheduler;
+  scheduleVBlankEvents();
+}
+
+void PPU::setHostStats(HostStats* stats) {
+  hostStats = stats;
+}
+
+void PPU::setScanlineRenderer(bool enabled) {
+  useScanlineRenderer = enabled;
+}
+
+void PPU::setRenderEnabled(bool enabled) {
+  renderEnabled = enabled;
+}
+
+uint64_t PPU::getDrawnFrameCount() const {
+  return drawnFrameCount;
+}
+
+void PPU::setRenderPipeline(RenderPipeline* pipeline) {
+  renderPipeline = pipeline;
+}
+
+namespace {
+  struct StateWriter {
+    std::vector<Byte>& state;
+
+    template <typename T>
+    void operator()(const T& value) {
+      const Byte* bytes{ reinterpret_cast<const Byte*>(&value) };
+      state.insert(state.end(), bytes, bytes + sizeof(T));
+    }
+
+    void operator()(const std::vector<Byte>& bytes) {
+      state.insert(state.end(), bytes.begin(), bytes.end());
+    }
+  };
+
+  struct StateReader {
+    const Byte* state;
+
+    template <typename T>
+    void operator()(T& value) {
+      std::memcpy(&value, state, sizeof(T));
+      state += sizeof(T);
+    }
+
+    void operator()(std::vector<Byte>& bytes) {
+      std::memcpy(bytes.data(), state, bytes.size());
+      state += bytes.size();
+    }
+  };
+
+  struct StateSize {
+    size_t size;
+
+    template <typename T>
+    void operator()(const T&) {
+      size += sizeof(T);
+    }
+
+    void operator()(const std::vector<Byte>& bytes) {
+      size += bytes.size();
+    }
+  };
+}
+
+template <typename Self, typename Visitor>
+void OAM::visitState(Self& self, Visitor& visit) {
+  visit(self.oam);
+  visit(self.secondaryOam);
+  visit(self.spritePixelData);
+  visit(self.oamAddr);
+  visit(self.secondaryOamAddr);
+  visit(self.spriteEvaluationEnd);
+  visit(self.readOffset);
+  visit(self.isSecondaryOamClearing);
+  visit(self.midFrameWriteFrame);
+}
+
+template <typename Self, typename Visitor>
+void Background::visitState(Self& self, Visitor& visit) {
+  visit(self.patternLow);
+  visit(self.patternHigh);
+  visit(self.attributeLow);
+  visit(self.attributeHigh);
+  visit(self.queuedPixels);
+}
+
+template <typename Self, typename Visitor>
+void PPU::visitState(Self& self, Visitor& visit) {
+  visit(self.memory);
+  visit(self.ppuCtrl);
+  visit(self.ppuMask);
+  visit(self.ppuStatus);
+  visit(self.v);
+  visit(self.t);
+  visit(self.x);
+  visit(self.w);
+  visit(self.readBuffer);
+  visit(self.cycle);
+  visit(self.scanline);
+  visit(self.isEvenFrame);
+  visit(self.frame);
+  visit(self.clock);
+  visit(self.first);
+  visit(self.disableNextNMI);
+  visit(self.mirroring);
+  OAM::visitState(self.oam, visit);
+  Background::visitState(self.background, visit);
+}
+
+void PPU::saveState(std::vector<Byte>& state) const {
+  StateWriter writer{state};
+  visitState(*this, writer);
+}
+
+bool PPU::loadState(const std::vector<Byte>& state) {
+  StateSize expected{};
+  visitState(*this, expected);
+  if (state.size() != expected.size)
+    return false;
+
+  // memory is the first member of the state, only the tiles that differ have to be decoded again
+  for (int addr{}; addr < 0x2000; addr += 16) {
+    if (std::memcmp(&state[addr], &memory[addr], 16) != 0)
+      tileCache.invalidate(addr);
+  }
+
+  StateReader reader{state.data()};
+  visitState(*this, reader);
+
+  setMirroring(mirroring);
+  oam.spriteTableHeight = 0;
+  isFrameRendered = renderEnabled && !renderPipeline;
+  return true;
+}
+
+void PPU::startFrame() {
+  isEvenFrame = !isEvenFrame;
+  frame += 1;
+
+  // With a pipeline attached its shadow PPU draws the frame instead
+  isFrameRendered = renderEnabled && !renderPipeline;
+  if (renderPipeline)
+    renderPipeline->recordFrameStart(renderEnabled);
+}
+
+void PPU::projectPosition(uint64_t targetClock, int& projectedScanline, int& projectedCycle) const {
+  constexpr int FRAME_LENGTH{ 262 * 341 };
+  constexpr int ODD_FRAME_SKIP{ 261 * 341 + 340 };
+
+  const int position{ getFramePosition() };
+  int64_t projected{ position + static_cast<int64_t>(targetClock - clock) };
+  // Before power up has executed a single cycle
+  if (projected < 0) {
+    projectedScanline = scanline;
+    projectedCycle = cycle;
+    return;
+  }
+
+  // Cycle 340 of the pre-render scanline is skipped on odd frames while rendering
+  if (!first && isRendering() && !isEvenFrame && position < ODD_FRAME_SKIP && projected >= ODD_FRAME_SKIP)
+    projected++;
+
+  projected %= FRAME_LENGTH;
+  projectedScanline = static_cast<int>(projected / 341);
+  projectedCycle = static_cast<int>(projected % 341);
+}
+
+int PPU::getFramePosition() const {
+  // Before the first cycle is executed scanline and cycle are both -1
+  return scanline < 0 ? -1 : scanline * 341 + cycle;
+}
+
+void PPU::scheduleVBlankEvents() {
+  if (!scheduler)
+    return;
+
+  constexpr int FRAME_LENGTH{ 262 * 341 };
+  constexpr int VBLANK_START{ 241 * 341 + 1 };
+  constexpr int VBLANK_END{ 261 * 341 + 1 };
+
+  const int position{ getFramePosition() };
+  int untilStart{ VBLANK_START - position };
+  int untilEnd{ VBLANK_END - position };
+  if (untilStart <= 0)
+    untilStart += FRAME_LENGTH;
+  if (untilEnd <= 0)
+    untilEnd += FRAME_LENGTH;
+
+  // One cycle earlier in case the odd frame skip happens before the event
+  scheduler->schedule(EventType::VBLANK_START, clock + untilStart - 1);
+  scheduler->schedule(EventType::VBLANK_END, clock + untilEnd - 1);
+}
+
+void PPU::signalNMIChange() {
+  if (scheduler)
+    scheduler->schedule(EventType::NMI, clock);
+}
+
+const char* getMirroringName(Mirroring mirroring) {
+  switch (mirroring) {
+    case Mirroring::HORIZONTAL:
+      return "Horizontal";
+    case Mirroring::VERTICAL:
+      return "Vertical";
+    case Mirroring::SINGLE_LOW:
+      return "Single Screen Low";
+    case Mirroring::SINGLE_HIGH:
+      return "Single Screen High";
+    case Mirroring::FOUR_SCREEN:
+      return "Four Screen";
     default:
-      break;
+      return "Unknown";
   }
+}
 
-  return addr;
+void PPU::setMirroring(Mirroring newMirroring) {
+  // 1 KB slot of nametable memory for each of the 4 nametables
+  static constexpr std::array<std::array<int, 4>, 5> SLOTS{{
+    {0, 0, 1, 1},
+    {0, 1, 0, 1},
+    {0, 0, 0, 0},
+    {1, 1, 1, 1},
+    {0, 1, 2, 3}
+  }};
+
+  mirroring = newMirroring;
+  for (int nametable{}; nametable < 4; nametable++) {
+    Byte* slot{ &memory[0x2000 + SLOTS[static_cast<int>(mirroring)][nametable] * 0x400] };
+    pages[8 + nametable] = slot;
+    pages[12 + nametable] = slot;
+  }
+
+  if (renderPipeline)
+    renderPipeline->recordMirroring(mirroring);
+}
+
+Mirroring PPU::getMirroring() const {
+  return mirroring;
 }
 
 Byte PPU::readMemory(Word addr) {
-  return memory[mapMemory(addr)];
+  addr &= 0x3FFF;
+  if (addr >= 0x3F00)
+    return memory[0x3F00 | (addr & 0x1F)];
+  return pages[addr >> 10][addr & 0x3FF];
 }
 
 void PPU::writeMemory(Word addr, Byte input) {
-  memory[mapMemory(addr)] = input;
+  addr &= 0x3FFF;
+  if (addr >= 0x3F00) {
+    // Entry 0 of every sprite palette is the same byte as entry 0 of the matching background palette
+    const Word index{ static_cast<Word>(addr & 0x1F) };
+    memory[0x3F00 | index] = input;
+    if ((index & 0b11) == 0)
+      memory[0x3F00 | (index ^ 0x10)] = input;
+    return;
+  }
+
+  pages[addr >> 10][addr & 0x3FF] = input;
+  tileCache.invalidate(addr);
 }
 
 // internal rendering system
@@ -422,7 +827,7 @@ void PPU::handlePreRenderScanline() {
         v &= 0x7BE0;
         v |= (t & 0x41F);
       }
-      background.clearDeque();
+      background.clearShifters();
       break;
     case 280 ... 304:
       if (isRendering()) {
@@ -442,6 +847,86 @@ void PPU::handlePreRenderScanline() {
 // Drawing
 
 void PPU::handleDraw() {
+  const PixelData bg{ background.getPixelData() };
+  const PixelData sprite{ oam.getPixelData(cycle - 1) };
+
+  // Only a sprite 0 pixel can change anything in a frame that is not drawn
+  if (!isFrameRendered) {
+    if (sprite & 0b0010'0000)
+      composePixel(cycle - 1, bg, sprite);
+    return;
+  }
+
+  Byte color{ readMemory(0x3F00 | composePixel(cycle - 1, bg, sprite)) };
+  sink.drawPixel(cycle - 1, scanline, ppuMask & 0b1 ? (color & 0x30) : color, ppuMask);
+}
+
+bool PPU::canRenderScanline() const {
+  return useScanlineRenderer && isRendering() && background.canRenderScanline();
+}
+
+void PPU::renderScanline() {
+  std::array<PixelData, EmuConst::SCREEN_WIDTH> spriteLine;
+  oam.takeLinePixelData(spriteLine.data());
+
+  // Cycle 1 to 256
+  if (isFrameRendered)
+    drawScanline(spriteLine.data());
+  else
+    skipScanline(spriteLine.data());
+
+  // Cycle 1 to 320 of the sprite evaluation, it only writes the sprite pixels of the next line that were all
+  // read above
+  oam.renderScanline();
+
+  // Cycle 257
+  v &= 0x7BE0;
+  v |= (t & 0x41F);
+
+  // Cycle 321 to 336
+  background.prefetchTiles();
+
+  clock += 340;
+  cycle = 340;
+}
+
+void PPU::drawScanline(const PixelData* sprites) {
+  std::array<PixelData, 16 + EmuConst::SCREEN_WIDTH> backgroundLine;
+  background.renderScanline(backgroundLine.data());
+
+  // Palette memory cannot be written during the line, so it is read once
+  std::array<Byte, 0x20> palette;
+  for (int i{}; i < 0x20; i++) {
+    const Byte color{ memory[0x3F00 | i] };
+    palette[i] = ppuMask & 0b1 ? (color & 0x30) : color;
+  }
+
+  std::array<Byte, EmuConst::SCREEN_WIDTH> line;
+  if (composeLine(&backgroundLine[x], sprites, palette.data(), ppuMask, line.data()))
+    ppuStatus |= 0b0100'0000;
+  sink.drawScanline(scanline, line.data(), ppuMask);
+}
+
+void PPU::skipScanline(const PixelData* sprites) {
+  const bool hasSprite0{
+    std::any_of(sprites, sprites + EmuConst::SCREEN_WIDTH, [](PixelData sprite) { return sprite & 0b0010'0000; })
+  };
+  if (!hasSprite0) {
+    background.skipScanline();
+    return;
+  }
+
+  // The background pixels are still needed to find the sprite 0 hit, the colours are not
+  std::array<PixelData, 16 + EmuConst::SCREEN_WIDTH> backgroundLine;
+  background.renderScanline(backgroundLine.data());
+
+  const std::array<Byte, 0x20> palette{};
+  std::array<Byte, EmuConst::SCREEN_WIDTH> line;
+  if (composeLine(&backgroundLine[x], sprites, palette.data(), ppuMask, line.data()))
+    ppuStatus |= 0b0100'0000;
+}
+
+Byte PPU::composePixel(int column, PixelData bg, PixelData sprite) {
   int bgPixelValue;
   int bgColorMemAddr;
   int priority;
@@ -449,21 +934,19 @@ void PPU::handleDraw() {
   int spriteColorMemAddr;
   Word colorMemAddr{};
 
-  const PixelData bg{ background.getPixelData() };
   bgPixelValue = bg & 0b11;
   bgColorMemAddr = 0x3F00 | (bg & 0x1F);
 
-  const PixelData sprite{oam.getPixelData(cycle - 1) };
   priority = (sprite & 0b0100'0000) >> 6;
   spritePixelValue = sprite & 0b11;
   spriteColorMemAddr = 0x3F00 | (sprite & 0x1F);
 
-  if ((ppuMask & 0b0100) == 0 && cycle - 1 < 8) {
+  if ((ppuMask & 0b0100) == 0 && column < 8) {
     spritePixelValue = 0;
     spriteColorMemAddr = 0x3F00;
   }
 
-  if ((ppuMask & 0b0010) == 0 && cycle - 1 < 8) {
+  if ((ppuMask & 0b0010) == 0 && column < 8) {
     bgPixelValue = 0;
     bgColorMemAddr = 0x3F00;
   }
@@ -495,26 +978,35 @@ void PPU::handleDraw() {
     colorMemAddr = 0x3F00;
   }
 
-  Byte color{ readMemory(colorMemAddr) };
-  display.drawPixel(cycle - 1, scanline, ppuMask & 0b1 ? (color & 0x30) : color, ppuMask);
+  return colorMemAddr & 0x1F;
 }
 
-
 // Register stuff
 
 // For CPU access
 void PPU::writePPUCtrl(Byte val) {
+  if (renderPipeline)
+    renderPipeline->recordWrite(0x2000, val);
+
   setBit(t, 10, 11, extractBit(val, 0, 1));
   ppuCtrl = val;
+  signalNMIChange();
 }
 
 void PPU::writePPUMask(Byte val) {
+  if (renderPipeline)
+    renderPipeline->recordWrite(0x2001, val);
+
   ppuMask = val;
 }
 
 Byte PPU::readPPUStatus() {
+  if (renderPipeline)
+    renderPipeline->recordRead(0x2002);
+
   Byte temp{ppuStatus };
   clearBit(ppuStatus, 7, 7);
+  signalNMIChange();
   w = 0;
   if (scanline == 240 && cycle == 340)
     disableNextNMI = true;
@@ -522,6 +1014,9 @@ Byte PPU::readPPUStatus() {
 }
 
 void PPU::writeOAMAddr(Byte val) {
+  if (renderPipeline)
+    renderPipeline->recordWrite(0x2003, val);
+
   oam.writeOAMAddr(val);
 }
 
@@ -530,10 +1025,16 @@ Byte PPU::readOAMData() {
 }
 
 void PPU::writeOAMData(Byte val) {
+  if (renderPipeline)
+    renderPipeline->recordWrite(0x2004, val);
+
   oam.writeOAMData(val);
 }
 
 void PPU::writePPUScroll(Byte val) {
+  if (renderPipeline)
+    renderPipeline->recordWrite(0x2005, val);
+
   if (w) {
     setBit(t, 5, 9, extractBit(val, 3, 7));
     setBit(t, 12, 14, extractBit(val, 0, 2));
@@ -546,6 +1047,9 @@ void PPU::writePPUScroll(Byte val) {
 }
 
 void PPU::writePPUAddr(Byte val) {
+  if (renderPipeline)
+    renderPipeline->recordWrite(0x2006, val);
+
   if (w) {
     setBit(t, 0, 7, val);
     v = t;
@@ -559,26 +1063,34 @@ void PPU::writePPUAddr(Byte val) {
 
 // Read VRAM, not the entire address space
 Byte PPU::readPPUData() {
-  static Byte buffer{};
+  if (renderPipeline)
+    renderPipeline->recordRead(0x2007);
+
   Byte temp;
   if (0x3F00 <= v && v <= 0x3FFF) {
     temp = readMemory(v);
-    buffer = readMemory((v & 0x0FFF) + 0x2000);
+    readBuffer = readMemory((v & 0x0FFF) + 0x2000);
   } else {
-    temp = buffer;
-    buffer = readMemory(v);
+    temp = readBuffer;
+    readBuffer = readMemory(v);
   }
   v += extractBit(ppuCtrl, 2, 2) ? 32 : 1;
   return temp;
 }
 
 void PPU::writePPUData(Byte val) {
+  if (renderPipeline)
+    renderPipeline->recordWrite(0x2007, val);
+
   writeMemory(v, val);
   v += extractBit(ppuCtrl, 2, 2) ? 32 : 1;
 }
 
-void PPU::writeOAMDma(std::vector<Byte>& cpuMem, Byte input) {
-  oam.DMA(cpuMem, input);
+void PPU::writeOAMDma(const Byte* page) {
+  if (renderPipeline)
+    renderPipeline->recordDMA(page);
+
+  oam.DMA(page);
 }
 
 bool PPU::isRendering() const {
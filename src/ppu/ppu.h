@@ -1,11 +1,14 @@
 #ifndef NESEMULATOR_PPU_H
 #define NESEMULATOR_PPU_H
 
-#include "../display/display.h"
+#include "../display/frame_sink.h"
 #include "../constants.h"
+#include "../scheduler/scheduler.h"
+#include "../stats/host_stats.h"
+#include "tile_cache.h"
 #include <vector>
+#include <array>
 #include <cstdint>
-#include <queue>
 
 /**
  * \brief First 5 bit = paletteIndex, bit 5 = isSprite0, bit 6 = priority, bit 7 = hasBeenWrittenTo
@@ -16,11 +19,27 @@ using PixelData = uint8_t;
 class Initializer;
 class PPU;
 class DebugDisplay;
+class RenderPipeline;
+
+/**
+ * \brief How the 4 nametables at $2000, $2400, $2800 and $2C00 map onto the nametable memory
+ */
+enum class Mirroring : Byte {
+  HORIZONTAL,  // $2000 = $2400 and $2800 = $2C00
+  VERTICAL,    // $2000 = $2800 and $2400 = $2C00
+  SINGLE_LOW,  // All 4 are the first 1 KB of nametable memory
+  SINGLE_HIGH, // All 4 are the second 1 KB of nametable memory
+  FOUR_SCREEN  // 4 separate nametables, the cartridge provides the extra 2 KB
+};
+
+const char* getMirroringName(Mirroring mirroring);
 
 /**
  * \brief Class to handle <a href="https://www.nesdev.org/wiki/PPU_OAM">OAM</a> Operations
  */
 class OAM {
+  friend class PPU;
+
 public:
   /**
    * \brief Initialise OAM
@@ -37,6 +56,13 @@ public:
    */
   PixelData getPixelData(int x);
 
+  /**
+   * \brief Take the Sprite Pixel Data of the whole line, getPixelData() on every x-position at once
+   * \param line SCREEN_WIDTH PixelData, x-position 0 first
+   * \warning This will clear the spritePixelData
+   */
+  void takeLinePixelData(PixelData* line);
+
   /**
    * \brief Execute the OAM operation at the current cycle and scanline of PPU
    * \note Call this function from scanline 0 to scanline 239 (inclusive) of PPU
@@ -66,10 +92,15 @@ public:
 
   /**
    * \brief <a href="https://www.nesdev.org/wiki/DMA#:~:text=Examples%20%2D%20General%20behavior-,OAM%20DMA,-OAM%20DMA%20copies">OAM DMA</a> Process
-   * \param cpuMem reference to CPU Memory Array
-   * \param input If input is XX, data is from CPU page $XX00–$XXFF
+   * \param page start of the 256 byte CPU page to copy from, if $4014 is written with XX this is page $XX00–$XXFF
    */
-  void DMA(std::vector<Byte>& cpuMem, Byte input);
+  void DMA(const Byte* page);
+
+  /**
+   * \brief Execute the OAM operation of cycle 1 to 320 of the current scanline of PPU at once
+   * \note Same result as calling tick() on each of those cycles while rendering is enabled
+   */
+  void renderScanline();
 
 private:
   /**
@@ -87,6 +118,29 @@ private:
    */
   void evaluateSpriteData(int index);
 
+  /**
+   * \brief Fill secondary OAM for the current scanline from spriteTable, the result of evaluateOAM() on cycle 65 to 256
+   * \return false if the line has to be evaluated step by step: OAMADDR is not 0, OAM was written earlier in this
+   * frame while rendering, or 8 or more sprites are in range so the sprite overflow evaluation has to run
+   */
+  bool evaluateFromSpriteTable();
+
+  /**
+   * \brief Find the sprites in range of every scanline for sprites of height rows
+   */
+  void buildSpriteTable(int height);
+
+  /**
+   * \brief Called on every OAM write, the table is rebuilt on next use
+   */
+  void invalidateSpriteTable();
+
+  /**
+   * \brief Call visit on every member making up the OAM state, in a fixed order, see PPU::saveState()
+   */
+  template <typename Self, typename Visitor>
+  static void visitState(Self& self, Visitor& visit);
+
   /**
    * \brief Reference to the PPU that own this OAM
    */
@@ -137,6 +191,30 @@ private:
    * \brief Store the OAM Data read on odd cycle
    */
    Byte isSecondaryOamClearing;
+
+  /**
+   * \brief Sprites in range of a scanline, the OAM index of the first 8 in OAM order
+   * \note count stops at 8, which means 8 or more
+   */
+  struct ScanlineSprites {
+    int count;
+    std::array<Byte, 8> indices;
+  };
+
+  /**
+   * \brief Sprites in range of each visible scanline, built once OAM stops changing (usually after the OAM DMA)
+   */
+  std::array<ScanlineSprites, EmuConst::SCREEN_HEIGHT> spriteTable;
+
+  /**
+   * \brief Sprite height spriteTable was built for, 0 if OAM was written since
+   */
+  int spriteTableHeight;
+
+  /**
+   * \brief The last frame in which OAM was written while rendering, the rest of that frame is evaluated step by step
+   */
+  int midFrameWriteFrame;
 };
 
 
@@ -145,6 +223,8 @@ private:
  * \brief Class to handle Background Rendering Process of PPU
  */
 class Background {
+  friend class PPU;
+
 public:
   /**
    * \brief Initialise Background Rendering
@@ -159,18 +239,73 @@ public:
   void tick();
 
   /**
-   * \brief Get the Background Pixel Data at the front of the queue
-   * \note If used correctly, it will return the Background Pixel Data of x-position ppu.cycle - 1.
-   * This will also pop the Pixel Data off the queue. Return 0 if queue is empty
+   * \brief Get the Background Pixel Data at x-position ppu.cycle - 1 and shift it out
+   * \note The pixel is fine x scroll bits into the shifters. Return 0 if no pixel is queued
    */
   PixelData getPixelData();
 
   /**
-   * \brief Clear Background Pixel Data deque
+   * \brief Empty the shifters
+   */
+  void clearShifters();
+
+  /**
+   * \brief Whether renderScanline() can be used, i.e. exactly the 2 prefetched tiles are queued
+   */
+  [[nodiscard]] bool canRenderScanline() const;
+
+  /**
+   * \brief Execute the Background operation of cycle 1 to 256 of the current scanline of PPU at once
+   * \param line receives the 16 queued pixels followed by the 256 pixels fetched, the pixel at x-position i is
+   * line[i + fine x]
+   * \note Same result as calling tick() and getPixelData() on each of those cycles while rendering is enabled
+   */
+  void renderScanline(PixelData* line);
+
+  /**
+   * \brief Same as renderScanline() without producing any pixel, only v and the shifters are updated
+   */
+  void skipScanline();
+
+  /**
+   * \brief Fetch the first 2 tiles of the next scanline, what tick() does from cycle 321 to 336
    */
-  void clearDeque();
+  void prefetchTiles();
 
 private:
+  /**
+   * \brief One row of a background tile, as found from the name table and attribute table
+   */
+  struct Tile {
+    Word patternAddr; // Address of the low plane byte of the row
+    Byte attribute; // The 2 palette bits of this tile only
+  };
+
+  /**
+   * \brief Fetch the row of the tile at v and increment coarse x
+   */
+  Tile fetchTile();
+
+  /**
+   * \brief Read the pattern of tile into the shifters right after the pixels still queued
+   */
+  void loadTile(const Tile& tile);
+
+  /**
+   * \brief Write the 8 PixelData of tile, leftmost pixel first, from the tile cache
+   */
+  void decodeTile(const Tile& tile, PixelData* pixels);
+
+  /**
+   * \brief Increment fine y, and coarse y once fine y overflows
+   */
+  void incrementY();
+
+  /**
+   * \brief Call visit on every member making up the Background state, in a fixed order, see PPU::saveState()
+   */
+  template <typename Self, typename Visitor>
+  static void visitState(Self& self, Visitor& visit);
 
   /**
    * \brief Reference to the PPU that own this Background Rendering Process
@@ -183,9 +318,19 @@ private:
   Word& v;
 
   /**
-  * \brief Queue to store the result of the Background Rendering Process
-  */
-  std::deque<PixelData> backgroundPixelData;
+   * \brief Pattern and palette bits of the queued pixels, the next pixel is at bit 15 and each pixel drawn
+   * shifts them left by 1, like the 16-bit shift registers of the PPU
+   * \note The palette bits are kept per pixel instead of in the 8-bit shifters fed by a latch as on hardware
+   */
+  Word patternLow;
+  Word patternHigh;
+  Word attributeLow;
+  Word attributeHigh;
+
+  /**
+   * \brief Number of pixels loaded into the shifters and not drawn yet, 0 to 16
+   */
+  int queuedPixels;
 };
 
 
@@ -195,9 +340,17 @@ class PPU {
   friend class OAM;
   friend class Background;
   friend class DebugDisplay;
+  friend class RenderPipeline;
 
 public:
-  explicit PPU(Display& display);
+  explicit PPU(FrameSink& sink);
+
+  /**
+   * \brief Not copyable, pages and the OAM and background point into the PPU they were made for. Use saveState() and
+   * loadState() to copy the emulation state
+   */
+  PPU(const PPU&) = delete;
+  PPU& operator=(const PPU&) = delete;
 
   Byte readPPUStatus();
   [[nodiscard]] Byte readOAMData();
@@ -210,7 +363,7 @@ public:
   void writePPUScroll(Byte val);
   void writePPUAddr(Byte val);
   void writePPUData(Byte val);
-  void writeOAMDma(std::vector<Byte>& cpuMem, Byte input);
+  void writeOAMDma(const Byte* page);
 
   // Emulation
   Byte readPPUStatusNoSideEffect() const;
@@ -218,6 +371,79 @@ public:
 
   void executeNextClock();
 
+  /**
+   * \brief Execute PPU cycles until clock reaches targetClock
+   * \note Idle vblank scanlines are skipped in one step instead of cycle by cycle
+   */
+  void runUntil(uint64_t targetClock);
+
+  /**
+   * \brief Post the PPU events to scheduler from now on, times are in PPU clock
+   * \note VBLANK_START and VBLANK_END are posted at or before the cycle the vblank flag changes, and refreshed by
+   * runUntil(). NMI is posted at the current clock whenever the vblank flag or the NMI enable bit changes
+   */
+  void attachScheduler(Scheduler& scheduler);
+
+  /**
+   * \brief Get the scanline and cycle the PPU will be at once it has run to targetClock, without running it
+   * \note Assumes rendering is not toggled before targetClock, which holds up to the next event clock
+   */
+  void projectPosition(uint64_t targetClock, int& projectedScanline, int& projectedCycle) const;
+
+  /**
+   * \brief Count the host time of presenting frames into stats, nullptr to stop counting
+   */
+  void setHostStats(HostStats* stats);
+
+  /**
+   * \brief Choose whether whole visible scanlines are rendered at once when possible, or always dot by dot
+   * \note Both give the same result, the dot renderer is kept as the reference and for benchmarking
+   */
+  void setScanlineRenderer(bool enabled);
+
+  /**
+   * \brief Choose whether frames are drawn, takes effect from the next frame on
+   * \note A frame that is not drawn still runs all of its timing, vblank and NMI, sprite evaluation (with sprite
+   * overflow) and sprite 0 hit, so the emulated program runs exactly the same. No pixel reaches the FrameSink and
+   * updateScreen() is not called for it
+   */
+  void setRenderEnabled(bool enabled);
+
+  /**
+   * \brief Get the number of frames handed to the FrameSink with updateScreen() so far
+   * \note A frame is drawn or not as setRenderEnabled() was at its start, so callers switching it per frame can tell
+   * from this which of their decisions a completed frame followed
+   */
+  [[nodiscard]] uint64_t getDrawnFrameCount() const;
+
+  /**
+   * \brief Append the whole emulation state of the PPU to state: memory, registers, OAM, the background shifters and
+   * the position in the frame
+   * \note Settings (sink, scheduler, host stats, renderer choice, render enabled) are not part of the state
+   */
+  void saveState(std::vector<Byte>& state) const;
+
+  /**
+   * \brief Restore a state written by saveState()
+   * \return false if state is not a PPU state, the PPU is left unchanged then
+   * \note Only the tiles whose pattern bytes differ are decoded again, and whether the current frame is drawn
+   * follows setRenderEnabled()
+   */
+  bool loadState(const std::vector<Byte>& state);
+
+  /**
+   * \brief Map the 4 nametables according to mirroring, takes effect immediately
+   * \note The nametable memory itself is kept, so mappers can switch mirroring during a frame
+   */
+  void setMirroring(Mirroring mirroring);
+  [[nodiscard]] Mirroring getMirroring() const;
+
+  /**
+   * \brief Record every register access into pipeline and hand it each frame, nullptr to stop recording
+   * \note Set by RenderPipeline
+   */
+  void setRenderPipeline(RenderPipeline* pipeline);
+
   // TODO move back to private once done testing
   std::vector<Byte> memory;
 
@@ -226,16 +452,22 @@ public:
   int scanline;
   bool isEvenFrame;
   int frame;
+  uint64_t clock; // Number of PPU cycles executed since power up
   bool disableNextNMI;
-  bool nametableArrangement; // 0 = vertical arrangement, 1 = horizontal arrangement
 
   Word v;
 private:
-  Display& display;
+  FrameSink& sink;
+  TileCache tileCache;
   OAM oam;
   Background background;
 
   // Memory
+  // $0000 - $1FFF pattern tables, $2000 - $2FFF nametable memory (4 KB, only 2 KB of it used unless four screen),
+  // $3F00 - $3F1F palette memory. Palette bytes mirrored at $3F10, $3F14, $3F18 and $3F1C are written to both places,
+  // so reads never have to resolve them
+  Mirroring mirroring;
+  std::array<Byte*, 16> pages; // 1 KB pages of the address space $0000 - $3FFF, $3000 - $3FFF mirrors $2000 - $2FFF
 
   // Register
   Byte ppuCtrl;
@@ -247,18 +479,69 @@ private:
   Word t;
   Word x;
   Word w;
+  Byte readBuffer; // PPUDATA read buffer, reads outside the palette return the previous read
 
   // Check whether it is the first frame
   bool first;
 
+  Scheduler* scheduler;
+  HostStats* hostStats;
+  RenderPipeline* renderPipeline;
+
+  bool useScanlineRenderer; // Render whole visible scanlines at once when nothing can change during them
+  bool renderEnabled; // Set by setRenderEnabled()
+  bool isFrameRendered; // renderEnabled latched at the start of the current frame
+  uint64_t drawnFrameCount;
+
+  /**
+   * \brief Call visit on every member making up the PPU state, in a fixed order, memory first
+   */
+  template <typename Self, typename Visitor>
+  static void visitState(Self& self, Visitor& visit);
+
+  void scheduleVBlankEvents();
+  void signalNMIChange();
+  [[nodiscard]] int getFramePosition() const;
+
   // Memory Mapping
   Byte readMemory(Word addr);
   void writeMemory(Word addr, Byte input);
-  [[nodiscard]] Word mapMemory(Word addr) const;
 
   void handleVisibleScanline();
   void handlePreRenderScanline();
   void handleDraw();
+
+  /**
+   * \brief Resolve the background and sprite pixel at x-position column, setting sprite 0 hit
+   * \return index of the colour in palette memory, 0x00 to 0x1F
+   */
+  Byte composePixel(int column, PixelData bg, PixelData sprite);
+
+  [[nodiscard]] bool canRenderScanline() const;
+
+  /**
+   * \brief Execute cycle 1 to 340 of the current visible scanline at once
+   * \note Only valid at cycle 0 with canRenderScanline(), the result is the same as executing the cycles one by one
+   */
+  void renderScanline();
+
+  /**
+   * \brief Cycle 1 to 256 of renderScanline(), drawing the line to the FrameSink
+   * \param sprites SCREEN_WIDTH sprite PixelData of the line
+   */
+  void drawScanline(const PixelData* sprites);
+
+  /**
+   * \brief Cycle 1 to 256 of renderScanline() in a frame that is not drawn, only looking for sprite 0 hit
+   * \param sprites SCREEN_WIDTH sprite PixelData of the line
+   */
+  void skipScanline(const PixelData* sprites);
+
+  /**
+   * \brief Called when scanline 0 starts
+   */
+  void startFrame();
+
   [[nodiscard]] bool isRendering() const;
 };
 
@@ -0,0 +1,157 @@
+#include "render_pipeline.h"
+#include <chrono>
+
+template <typename Condition>
+void RenderPipeline::waitUntil(Condition isReady) {
+  for (int spins{}; !isReady(); spins++) {
+    if (spins < 64)
+      std::this_thread::yield();
+    else
+      std::this_thread::sleep_for(std::chrono::microseconds{100});
+  }
+}
+
+RenderPipeline::RenderPipeline(PPU& ppu, FrameSink& sink) : ppu{ppu}, shadow{sink},
+isFrameRendered{ppu.isFrameRendered}, packets{}, published{}, drawn{}, isStopping{} {
+  beginPacket();
+
+  // The shadow draws the rest of the current frame, so ppu stops drawing right away rather than from the next frame
+  ppu.isFrameRendered = false;
+  ppu.setRenderPipeline(this);
+  worker = std::thread{&RenderPipeline::runWorker, this};
+}
+
+RenderPipeline::~RenderPipeline() {
+  ppu.setRenderPipeline(nullptr);
+
+  // Hand over the frame recorded so far, ppu draws the rest of it
+  const uint64_t packet{ published.load(std::memory_order_relaxed) };
+  packets[packet % 2].endClock = ppu.clock;
+  published.store(packet + 1, std::memory_order_release);
+  flush();
+
+  isStopping.store(true, std::memory_order_release);
+  worker.join();
+
+  ppu.isFrameRendered = isFrameRendered;
+}
+
+void RenderPipeline::flush() {
+  const uint64_t target{ published.load(std::memory_order_relaxed) };
+  waitUntil([this, target] { return drawn.load(std::memory_order_acquire) >= target; });
+}
+
+uint64_t RenderPipeline::getFrameCount() const {
+  return published.load(std::memory_order_relaxed);
+}
+
+void RenderPipeline::recordWrite(Word addr, Byte value) {
+  packets[published.load(std::memory_order_relaxed) % 2].accesses.push_back({ppu.clock, addr, value, AccessType::WRITE});
+}
+
+void RenderPipeline::recordRead(Word addr) {
+  packets[published.load(std::memory_order_relaxed) % 2].accesses.push_back({ppu.clock, addr, 0, AccessType::READ});
+}
+
+void RenderPipeline::recordDMA(const Byte* page) {
+  FramePacket& packet{ packets[published.load(std::memory_order_relaxed) % 2] };
+  packet.accesses.push_back({ppu.clock, 0x4014, 0, AccessType::DMA});
+  packet.dmaPages.insert(packet.dmaPages.end(), page, page + 256);
+}
+
+void RenderPipeline::recordMirroring(Mirroring mirroring) {
+  packets[published.load(std::memory_order_relaxed) % 2].accesses.push_back(
+    {ppu.clock, 0, static_cast<Byte>(mirroring), AccessType::MIRRORING});
+}
+
+void RenderPipeline::recordFrameStart(bool isRendered) {
+  isFrameRendered = isRendered;
+  packets[published.load(std::memory_order_relaxed) % 2].isFrameRendered = isRendered;
+}
+
+void RenderPipeline::endFrame() {
+  const uint64_t packet{ published.load(std::memory_order_relaxed) };
+  packets[packet % 2].endClock = ppu.clock;
+  published.store(packet + 1, std::memory_order_release);
+  beginPacket();
+}
+
+void RenderPipeline::beginPacket() {
+  // The slot was last used 2 packets ago, which the worker has to be done with
+  const uint64_t packet{ published.load(std::memory_order_relaxed) };
+  waitUntil([this, packet] { return drawn.load(std::memory_order_acquire) + 2 > packet; });
+
+  FramePacket& next{ packets[packet % 2] };
+  next.state.clear();
+  next.accesses.clear();
+  next.dmaPages.clear();
+  next.isFrameRendered = isFrameRendered;
+  ppu.saveState(next.state);
+}
+
+void RenderPipeline::runWorker() {
+  while (true) {
+    const uint64_t packet{ drawn.load(std::memory_order_relaxed) };
+    waitUntil([this, packet] {
+      return published.load(std::memory_order_acquire) > packet || isStopping.load(std::memory_order_acquire);
+    });
+    if (published.load(std::memory_order_acquire) <= packet)
+      return;
+
+    // Every packet starts from its own snapshot, so one whose frame is not drawn has nothing to replay
+    if (packets[packet % 2].isFrameRendered)
+      replay(packets[packet % 2]);
+    drawn.store(packet + 1, std::memory_order_release);
+  }
+}
+
+void RenderPipeline::replay(const FramePacket& packet) {
+  // A packet holds at most one frame start, so latching the flag on loading and at that start draws what ppu would
+  shadow.setRenderEnabled(packet.isFrameRendered);
+  shadow.loadState(packet.state);
+
+  const Byte* dmaPage{ packet.dmaPages.data() };
+  for (const RegisterAccess& access : packet.accesses) {
+    shadow.runUntil(access.clock);
+
+    if (access.type == AccessType::DMA) {
+      shadow.writeOAMDma(dmaPage);
+      dmaPage += 256;
+    } else if (access.type == AccessType::MIRRORING) {
+      shadow.setMirroring(static_cast<Mirroring>(access.value));
+    } else if (access.type == AccessType::READ) {
+      if (access.addr == 0x2002)
+        shadow.readPPUStatus();
+      else
+        shadow.readPPUData();
+    } else {
+      switch (access.addr) {
+        case 0x2000:
+          shadow.writePPUCtrl(access.value);
+          break;
+        case 0x2001:
+          shadow.writePPUMask(access.value);
+          break;
+        case 0x2003:
+          shadow.writeOAMAddr(access.value);
+          break;
+        case 0x2004:
+          shadow.writeOAMData(access.value);
+          break;
+        case 0x2005:
+          shadow.writePPUScroll(access.value);
+          break;
+        case 0x2006:
+          shadow.writePPUAddr(access.value);
+          break;
+        case 0x2007:
+          shadow.writePPUData(access.value);
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  shadow.runUntil(packet.endClock);
+}
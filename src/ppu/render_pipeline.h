@@ -0,0 +1,117 @@
+#ifndef NESEMULATOR_RENDER_PIPELINE_H
+#define NESEMULATOR_RENDER_PIPELINE_H
+
+#include "ppu.h"
+#include "../display/frame_sink.h"
+#include "../constants.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+/**
+ * \brief Draws the frames of a PPU on a worker thread while the CPU emulates the next frame
+ * \note The emulated PPU only runs the frame logic (as if PPU::setRenderEnabled(false)) and records each register
+ * access and mirroring change that changes its state together with its PPU clock. At the start of every vblank the
+ * log, a snapshot of the PPU state at the previous vblank start and whether the frame is drawn are handed to the
+ * worker, which replays them on a shadow PPU drawing into the sink. The shadow goes through the exact same states as
+ * the emulated PPU, so the frames are the same pixel for pixel as drawing them inline, and frames the emulated PPU
+ * has rendering disabled for are not drawn. There are 2 frame slots: the one being recorded and the one being drawn
+ */
+class RenderPipeline {
+public:
+  /**
+   * \brief Start drawing the frames of ppu into sink on a worker thread, from the current position on
+   * \note sink is only used from the worker thread, call flush() before reading what it holds. It may be the sink of
+   * ppu, which stops drawing into it until the pipeline is destroyed. PPU::setRenderEnabled() on ppu keeps choosing
+   * which frames are drawn
+   */
+  RenderPipeline(PPU& ppu, FrameSink& sink);
+
+  /**
+   * \brief Draw what has been recorded up to the current position, then give drawing back to ppu
+   */
+  ~RenderPipeline();
+
+  RenderPipeline(const RenderPipeline&) = delete;
+  RenderPipeline& operator=(const RenderPipeline&) = delete;
+
+  /**
+   * \brief Wait until every frame handed over has been drawn
+   */
+  void flush();
+
+  /**
+   * \brief Get the number of frames handed over to the worker so far
+   */
+  [[nodiscard]] uint64_t getFrameCount() const;
+
+  // Called by the emulated PPU
+  void recordWrite(Word addr, Byte value);
+  void recordRead(Word addr);
+  void recordDMA(const Byte* page);
+  void recordMirroring(Mirroring mirroring);
+  void recordFrameStart(bool isRendered);
+  void endFrame();
+
+private:
+  enum class AccessType : Byte {
+    WRITE,
+    READ,
+    DMA,
+    MIRRORING
+  };
+
+  /**
+   * \brief A register access of the CPU, addr is $2000 to $2007 or $4014, or a mirroring change with the Mirroring
+   * in value
+   */
+  struct RegisterAccess {
+    uint64_t clock;
+    Word addr;
+    Byte value;
+    AccessType type;
+  };
+
+  /**
+   * \brief Everything the worker needs to draw one frame
+   */
+  struct FramePacket {
+    std::vector<Byte> state; // PPU::saveState() at the vblank start before the frame
+    std::vector<RegisterAccess> accesses;
+    std::vector<Byte> dmaPages; // 256 bytes per DMA access, in order
+    uint64_t endClock; // PPU clock right after the vblank start ending the frame
+    bool isFrameRendered; // Whether the frame is drawn, as latched by the emulated PPU
+  };
+
+  /**
+   * \brief Start recording the next packet once its slot is free
+   */
+  void beginPacket();
+
+  void runWorker();
+  void replay(const FramePacket& packet);
+
+  /**
+   * \brief Wait until isReady() holds, spinning a little first as the other side is usually about to finish
+   */
+  template <typename Condition>
+  static void waitUntil(Condition isReady);
+
+  PPU& ppu;
+  PPU shadow;
+  bool isFrameRendered; // Whether the frame being recorded is drawn, what ppu would have latched itself
+
+  std::array<FramePacket, 2> packets;
+
+  // Single producer (emulation), single consumer (worker): packet n uses slot n % 2, published counts the packets
+  // handed over and drawn the packets the worker is done with
+  std::atomic<uint64_t> published;
+  std::atomic<uint64_t> drawn;
+  std::atomic<bool> isStopping;
+
+  std::thread worker;
+};
+
+#endif
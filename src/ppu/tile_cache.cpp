@@ -0,0 +1,36 @@
+#include "tile_cache.h"
+#include <cstring>
+
+TileCache::TileCache(const std::vector<Byte>& memory) : memory{memory}, rows(TILE_COUNT * 2 * 8), stale{} {
+  stale.fill(true);
+}
+
+void TileCache::invalidate(Word addr) {
+  if (addr < 0x2000)
+    stale[addr >> 4] = true;
+}
+
+void TileCache::rebuild() {
+  for (int tile{}; tile < TILE_COUNT; tile++)
+    decode(tile);
+}
+
+void TileCache::decode(int tile) {
+  for (int row{}; row < 8; row++) {
+    const Byte low{ memory[tile * 16 + row] };
+    const Byte high{ memory[tile * 16 + 8 + row] };
+
+    Byte pixels[8];
+    Byte flippedPixels[8];
+    for (int i{}; i < 8; i++) {
+      const int bit{ 7 - i };
+      pixels[i] = ((low >> bit) & 1) | (((high >> bit) & 1) << 1);
+      flippedPixels[7 - i] = pixels[i];
+    }
+
+    std::memcpy(&rows[tile * 16 + row], pixels, 8);
+    std::memcpy(&rows[tile * 16 + 8 + row], flippedPixels, 8);
+  }
+
+  stale[tile] = false;
+}
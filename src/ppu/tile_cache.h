@@ -0,0 +1,67 @@
+#ifndef NESEMULATOR_TILE_CACHE_H
+#define NESEMULATOR_TILE_CACHE_H
+
+#include "../constants.h"
+#include <array>
+#include <vector>
+#include <cstdint>
+
+/**
+ * \brief The 512 tiles of the 2 pattern tables ($0000 - $1FFF) decoded to one byte per pixel
+ * \note Each row of a tile is 8 bytes of 2-bit pixel values, leftmost pixel first, kept both as is and flipped
+ * horizontally. A tile is decoded again the first time it is used after one of its bytes was written
+ */
+class TileCache {
+public:
+  static constexpr int TILE_COUNT{ 512 };
+
+  /**
+   * \param memory the PPU memory holding the pattern tables, it must outlive the cache
+   */
+  explicit TileCache(const std::vector<Byte>& memory);
+
+  /**
+   * \brief Mark the tile holding addr to be decoded again, does nothing if addr is not in the pattern tables
+   */
+  void invalidate(Word addr);
+
+  /**
+   * \brief Decode every tile now, used after the pattern tables were filled directly
+   */
+  void rebuild();
+
+  /**
+   * \brief Get a row of a tile as 8 pixel values, leftmost pixel first
+   * \param tile tile index, 0 to 511, i.e. the pattern address >> 4
+   * \param row row of the tile, 0 to 7
+   * \param flipped if set the row is mirrored horizontally
+   */
+  const Byte* getRow(int tile, int row, bool flipped) {
+    if (stale[tile])
+      decode(tile);
+    return reinterpret_cast<const Byte*>(&rows[(tile * 2 + flipped) * 8 + row]);
+  }
+
+  /**
+   * \brief Same as getRow() but as one 64-bit value, pixel i is byte i in memory order
+   */
+  uint64_t getRowBits(int tile, int row, bool flipped) {
+    if (stale[tile])
+      decode(tile);
+    return rows[(tile * 2 + flipped) * 8 + row];
+  }
+
+private:
+  void decode(int tile);
+
+  const std::vector<Byte>& memory;
+
+  /**
+   * \brief 8 rows of the tile followed by its 8 flipped rows, for every tile
+   */
+  std::vector<uint64_t> rows;
+
+  std::array<bool, TILE_COUNT> stale;
+};
+
+#endif
@@ -0,0 +1,31 @@
+#include "scheduler.h"
+#include <algorithm>
+
+Scheduler::Scheduler() : eventTimes{}, nextEventTime{NEVER} {
+  eventTimes.fill(NEVER);
+}
+
+void Scheduler::schedule(EventType type, uint64_t time) {
+  eventTimes[static_cast<int>(type)] = time;
+  updateNextEventTime();
+}
+
+void Scheduler::cancel(EventType type) {
+  schedule(type, NEVER);
+}
+
+bool Scheduler::isDue(EventType type, uint64_t now) const {
+  return eventTimes[static_cast<int>(type)] <= now;
+}
+
+uint64_t Scheduler::getEventTime(EventType type) const {
+  return eventTimes[static_cast<int>(type)];
+}
+
+uint64_t Scheduler::getNextEventTime() const {
+  return nextEventTime;
+}
+
+void Scheduler::updateNextEventTime() {
+  nextEventTime = *std::min_element(eventTimes.begin(), eventTimes.end());
+}
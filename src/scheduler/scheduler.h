@@ -0,0 +1,51 @@
+#ifndef NESEMULATOR_SCHEDULER_H
+#define NESEMULATOR_SCHEDULER_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+/**
+ * \brief Kinds of timed events, each kind has at most one pending event
+ */
+enum class EventType {
+  VBLANK_START, // PPU reaches scanline 241 cycle 1 and sets the vblank flag
+  VBLANK_END,   // PPU reaches scanline 261 cycle 1 and clears the vblank flag
+  NMI,          // The NMI inputs (vblank flag, NMI enable) changed or an NMI is waiting to be taken
+  COUNT
+};
+
+/**
+ * \brief Timestamped events on the master clock, which counts PPU cycles since power up
+ * \note Components post the time of their next event, the CPU loop only has to compare the current time with
+ * getNextEventTime() before each instruction and handle the due events when it is reached.
+ * With a handful of event kinds a slot per kind with a cached minimum is cheaper than a heap
+ */
+class Scheduler {
+public:
+  static constexpr uint64_t NEVER{ std::numeric_limits<uint64_t>::max() };
+
+  Scheduler();
+
+  /**
+   * \brief Post the event of this type at time, replacing the pending one
+   */
+  void schedule(EventType type, uint64_t time);
+  void cancel(EventType type);
+
+  [[nodiscard]] bool isDue(EventType type, uint64_t now) const;
+  [[nodiscard]] uint64_t getEventTime(EventType type) const;
+
+  /**
+   * \brief Get the time of the earliest pending event, NEVER if there is none
+   */
+  [[nodiscard]] uint64_t getNextEventTime() const;
+
+private:
+  std::array<uint64_t, static_cast<int>(EventType::COUNT)> eventTimes;
+  uint64_t nextEventTime;
+
+  void updateNextEventTime();
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "simd.h"
+
+#if defined(NES_SIMD_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+const char* getSimdLevelName(SimdLevel level) {
+  switch (level) {
+    case SimdLevel::SCALAR:
+      return "scalar";
+    case SimdLevel::SSE2:
+      return "sse2";
+    case SimdLevel::AVX2:
+      return "avx2";
+    default:
+      return "unknown";
+  }
+}
+
+static SimdLevel detectSimdLevel() {
+#if defined(NES_SIMD_X86) && defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  const int maxLeaf{ info[0] };
+
+  __cpuid(info, 1);
+  const bool sse2{ (info[3] & (1 << 26)) != 0 };
+  // AVX2 also needs the OS to save the YMM registers, which OSXSAVE and XCR0 tell
+  const bool osxsave{ (info[2] & (1 << 27)) != 0 };
+  bool avx2{};
+  if (maxLeaf >= 7 && osxsave && (_xgetbv(0) & 0b110) == 0b110) {
+    __cpuidex(info, 7, 0);
+    avx2 = (info[1] & (1 << 5)) != 0;
+  }
+
+  return avx2 ? SimdLevel::AVX2 : sse2 ? SimdLevel::SSE2 : SimdLevel::SCALAR;
+#elif defined(NES_SIMD_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return SimdLevel::AVX2;
+  if (__builtin_cpu_supports("sse2"))
+    return SimdLevel::SSE2;
+  return SimdLevel::SCALAR;
+#else
+  return SimdLevel::SCALAR;
+#endif
+}
+
+SimdLevel getSupportedSimdLevel() {
+  static const SimdLevel supported{ detectSimdLevel() };
+  return supported;
+}
+
+static SimdLevel& getSelectedSimdLevel() {
+  static SimdLevel selected{ getSupportedSimdLevel() };
+  return selected;
+}
+
+SimdLevel getSimdLevel() {
+  return getSelectedSimdLevel();
+}
+
+void setSimdLevel(SimdLevel level) {
+  getSelectedSimdLevel() = level < getSupportedSimdLevel() ? level : getSupportedSimdLevel();
+}
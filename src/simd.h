@@ -0,0 +1,45 @@
+#ifndef NESEMULATOR_SIMD_H
+#define NESEMULATOR_SIMD_H
+
+/**
+ * \brief Instruction sets the line kernels (composeLine(), convertLine()) can be run with, in increasing order
+ */
+enum class SimdLevel {
+  SCALAR,
+  SSE2,
+  AVX2
+};
+
+const char* getSimdLevelName(SimdLevel level);
+
+/**
+ * \brief Get the best instruction set supported by the host, detected once on first use
+ */
+SimdLevel getSupportedSimdLevel();
+
+/**
+ * \brief Get the instruction set the line kernels currently use
+ * \note Defaults to getSupportedSimdLevel()
+ */
+SimdLevel getSimdLevel();
+
+/**
+ * \brief Restrict the line kernels to level, used to compare the kernels against the scalar ones
+ * \note Levels above getSupportedSimdLevel() are lowered to it. Set it before any emulation starts
+ */
+void setSimdLevel(SimdLevel level);
+
+// The kernels are compiled for their instruction set with function attributes rather than per file flags, so the
+// rest of the emulator is still built for the baseline target
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NES_SIMD_X86
+#if defined(__GNUC__) || defined(__clang__)
+#define NES_TARGET_SSE2 __attribute__((target("sse2")))
+#define NES_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define NES_TARGET_SSE2
+#define NES_TARGET_AVX2
+#endif
+#endif
+
+#endif
@@ -0,0 +1,170 @@
+#include "host_stats.h"
+#include "../constants.h"
+#include <algorithm>
+#include <cstdio>
+
+const char* getSubsystemName(Subsystem subsystem) {
+  switch (subsystem) {
+    case Subsystem::CPU:
+      return "cpu";
+    case Subsystem::PPU:
+      return "ppu";
+    case Subsystem::DISPLAY:
+      return "display";
+    case Subsystem::DEBUG_DISPLAY:
+      return "debug_display";
+    case Subsystem::EVENTS:
+      return "events";
+    case Subsystem::PACING:
+      return "pacing";
+    default:
+      return "unknown";
+  }
+}
+
+HostStats::HostStats() : nanoseconds{}, stack{}, depth{}, lastSwitch{Clock::now()}, frameTimeBuckets{}, frameCount{},
+hostNanoseconds{}, emulatedCycles{}, lastFrameEnd{Clock::now()}, pacedFrameCount{}, missedDeadlines{},
+driftNanoseconds{}, maxLateNanoseconds{} {}
+
+static uint64_t getElapsed(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+}
+
+void HostStats::enter(Subsystem subsystem) {
+  const Clock::time_point now{ Clock::now() };
+  if (depth > 0)
+    nanoseconds[static_cast<int>(stack[std::min<int>(depth, stack.size()) - 1])] += getElapsed(lastSwitch, now);
+
+  // Deeper nesting than any caller needs is counted to the innermost tracked subsystem
+  if (depth < static_cast<int>(stack.size()))
+    stack[depth] = subsystem;
+  depth++;
+  lastSwitch = now;
+}
+
+void HostStats::leave() {
+  if (depth == 0)
+    return;
+
+  const Clock::time_point now{ Clock::now() };
+  nanoseconds[static_cast<int>(stack[std::min<int>(depth, stack.size()) - 1])] += getElapsed(lastSwitch, now);
+  depth--;
+  lastSwitch = now;
+}
+
+HostStats::Scope::Scope(HostStats* stats, Subsystem subsystem) : stats{stats} {
+  if (stats)
+    stats->enter(subsystem);
+}
+
+HostStats::Scope::~Scope() {
+  if (stats)
+    stats->leave();
+}
+
+void HostStats::endFrame(uint64_t cycles) {
+  const Clock::time_point now{ Clock::now() };
+  const uint64_t frameTime{ getElapsed(lastFrameEnd, now) };
+  lastFrameEnd = now;
+
+  frameTimeBuckets[std::min<uint64_t>(frameTime / BUCKET_NANOSECONDS, BUCKET_COUNT - 1)]++;
+  frameCount++;
+  hostNanoseconds += frameTime;
+  emulatedCycles += cycles;
+}
+
+void HostStats::addPacedFrame(int64_t lateNanoseconds, bool isMissed) {
+  pacedFrameCount++;
+  if (isMissed)
+    missedDeadlines++;
+  driftNanoseconds += lateNanoseconds < 0 ? -lateNanoseconds : lateNanoseconds;
+  maxLateNanoseconds = std::max(maxLateNanoseconds, lateNanoseconds);
+}
+
+void HostStats::reset() {
+  nanoseconds.fill(0);
+  depth = 0;
+  lastSwitch = Clock::now();
+  frameTimeBuckets.fill(0);
+  frameCount = 0;
+  hostNanoseconds = 0;
+  emulatedCycles = 0;
+  lastFrameEnd = lastSwitch;
+  pacedFrameCount = 0;
+  missedDeadlines = 0;
+  driftNanoseconds = 0;
+  maxLateNanoseconds = 0;
+}
+
+uint64_t HostStats::getNanoseconds(Subsystem subsystem) const {
+  return nanoseconds[static_cast<int>(subsystem)];
+}
+
+uint64_t HostStats::getFrameCount() const {
+  return frameCount;
+}
+
+double HostStats::getFrameTimePercentile(double percentile) const {
+  if (frameCount == 0)
+    return 0.0;
+
+  // Smallest bucket at which at least percentile % of the frames have been counted
+  const double target{ percentile / 100.0 * frameCount };
+  uint64_t counted{};
+  for (int bucket{}; bucket < BUCKET_COUNT; bucket++) {
+    counted += frameTimeBuckets[bucket];
+    if (counted > 0 && counted >= target)
+      return (bucket + 1) * BUCKET_NANOSECONDS / 1e6;
+  }
+  return BUCKET_COUNT * BUCKET_NANOSECONDS / 1e6;
+}
+
+double HostStats::getEmulatedFPS() const {
+  return hostNanoseconds == 0 ? 0.0 : frameCount / (hostNanoseconds / 1e9);
+}
+
+double HostStats::getSpeed() const {
+  return hostNanoseconds == 0 ? 0.0 : emulatedCycles / EmuConst::CPU_FREQUENCY / (hostNanoseconds / 1e9);
+}
+
+uint64_t HostStats::getPacedFrameCount() const {
+  return pacedFrameCount;
+}
+
+uint64_t HostStats::getMissedDeadlines() const {
+  return missedDeadlines;
+}
+
+double HostStats::getMeanDrift() const {
+  return pacedFrameCount == 0 ? 0.0 : driftNanoseconds / 1e6 / pacedFrameCount;
+}
+
+double HostStats::getMaxDrift() const {
+  return maxLateNanoseconds / 1e6;
+}
+
+void HostStats::writeJSON(std::ostream& out) const {
+  char line[128];
+  out << "{\n  \"subsystem_ns\": {";
+  for (int i{}; i < static_cast<int>(Subsystem::COUNT); i++) {
+    snprintf(line, sizeof(line), "%s\n    \"%s\": %llu", i == 0 ? "" : ",", getSubsystemName(static_cast<Subsystem>(i)),
+             static_cast<unsigned long long>(nanoseconds[i]));
+    out << line;
+  }
+  out << "\n  },\n";
+
+  snprintf(line, sizeof(line), "  \"frames\": %llu,\n  \"host_ns\": %llu,\n  \"emulated_cycles\": %llu,\n",
+           static_cast<unsigned long long>(frameCount), static_cast<unsigned long long>(hostNanoseconds),
+           static_cast<unsigned long long>(emulatedCycles));
+  out << line;
+  snprintf(line, sizeof(line), "  \"frame_ms\": { \"p50\": %.1f, \"p95\": %.1f, \"p99\": %.1f },\n",
+           getFrameTimePercentile(50), getFrameTimePercentile(95), getFrameTimePercentile(99));
+  out << line;
+  snprintf(line, sizeof(line), "  \"emulated_fps\": %.2f,\n  \"speed\": %.3f,\n", getEmulatedFPS(), getSpeed());
+  out << line;
+  snprintf(line, sizeof(line), "  \"paced_frames\": %llu,\n  \"missed_deadlines\": %llu,\n",
+           static_cast<unsigned long long>(pacedFrameCount), static_cast<unsigned long long>(missedDeadlines));
+  out << line;
+  snprintf(line, sizeof(line), "  \"drift_ms\": { \"mean\": %.3f, \"max\": %.3f }\n}\n", getMeanDrift(), getMaxDrift());
+  out << line;
+}
@@ -0,0 +1,130 @@
+#ifndef NESEMULATOR_HOST_STATS_H
+#define NESEMULATOR_HOST_STATS_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * \brief Parts of the emulator whose host time is measured separately
+ */
+enum class Subsystem {
+  CPU,           // CPU::run, excluding the PPU catching up
+  PPU,           // PPU::runUntil, excluding the frame sink
+  DISPLAY,       // FrameSink::updateScreen, presenting the finished frame
+  DEBUG_DISPLAY, // DebugDisplay::updateScreen
+  EVENTS,        // SDL event and keyboard handling
+  PACING,        // FramePacer waiting for the deadline of the frame
+  COUNT
+};
+
+const char* getSubsystemName(Subsystem subsystem);
+
+/**
+ * \brief Host time spent per subsystem and host time per emulated frame
+ * \note Subsystem time is exclusive: entering a subsystem pauses the one it was entered from, so the PPU catching
+ * up inside CPU::run is only counted as PPU time. Frame times go into a histogram of 0.1 ms buckets, which is what
+ * the percentiles are read from
+ */
+class HostStats {
+public:
+  static constexpr int BUCKET_COUNT{ 1000 };
+  static constexpr uint64_t BUCKET_NANOSECONDS{ 100'000 }; // Frame times of 100 ms and more share the last bucket
+
+  HostStats();
+
+  /**
+   * \brief Start counting host time for subsystem until the matching leave()
+   */
+  void enter(Subsystem subsystem);
+  void leave();
+
+  /**
+   * \brief Enter a subsystem for the lifetime of the scope, does nothing if stats is nullptr
+   */
+  class Scope {
+  public:
+    Scope(HostStats* stats, Subsystem subsystem);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    HostStats* stats;
+  };
+
+  /**
+   * \brief Close the current frame, its host time is the time since the previous endFrame() or reset()
+   * \param emulatedCycles CPU cycles emulated during the frame
+   */
+  void endFrame(uint64_t emulatedCycles);
+
+  /**
+   * \brief Count a frame kept to a schedule by FramePacer
+   * \param lateNanoseconds host time from the deadline of the frame to when it was done, negative if early
+   * \param isMissed whether the frame was late by more than a whole frame
+   */
+  void addPacedFrame(int64_t lateNanoseconds, bool isMissed);
+
+  void reset();
+
+  [[nodiscard]] uint64_t getNanoseconds(Subsystem subsystem) const;
+  [[nodiscard]] uint64_t getFrameCount() const;
+
+  /**
+   * \brief Get the frame time in milliseconds that percentile (0 to 100) of the frames did not exceed
+   * \note Resolution is the bucket size, the upper edge of the bucket is returned
+   */
+  [[nodiscard]] double getFrameTimePercentile(double percentile) const;
+
+  /**
+   * \brief Get the number of frames emulated per host second
+   */
+  [[nodiscard]] double getEmulatedFPS() const;
+
+  /**
+   * \brief Get emulated time divided by host time, 1.0 is real time
+   */
+  [[nodiscard]] double getSpeed() const;
+
+  [[nodiscard]] uint64_t getPacedFrameCount() const;
+  [[nodiscard]] uint64_t getMissedDeadlines() const;
+
+  /**
+   * \brief Get how far from their deadlines paced frames were done on average, early or late, in milliseconds
+   */
+  [[nodiscard]] double getMeanDrift() const;
+
+  /**
+   * \brief Get the latest a paced frame was done after its deadline, in milliseconds
+   */
+  [[nodiscard]] double getMaxDrift() const;
+
+  /**
+   * \brief Write every counter as a JSON object
+   */
+  void writeJSON(std::ostream& out) const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  std::array<uint64_t, static_cast<int>(Subsystem::COUNT)> nanoseconds;
+  std::array<Subsystem, 16> stack; // Entered subsystems, the last one is being timed
+  int depth;
+  Clock::time_point lastSwitch;
+
+  std::array<uint64_t, BUCKET_COUNT> frameTimeBuckets;
+  uint64_t frameCount;
+  uint64_t hostNanoseconds;
+  uint64_t emulatedCycles;
+  Clock::time_point lastFrameEnd;
+
+  uint64_t pacedFrameCount;
+  uint64_t missedDeadlines;
+  uint64_t driftNanoseconds; // Sum of the distance to the deadline, early or late
+  int64_t maxLateNanoseconds;
+};
+
+#endif
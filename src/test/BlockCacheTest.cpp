@@ -0,0 +1,72 @@
+#include <catch2/catch_all.hpp>
+#include <string>
+#include <vector>
+
+#define private public
+#include "test_emulator.h"
+
+TEST_CASE("Running from the decoded block cache matches stepping one instruction at a time") {
+  const std::string rom{ getTestRomPath(GENERATE("supermariobros.nes", "nestest.nes", "kungfu.nes")) };
+
+  Emulator stepped{rom};
+  Emulator cached{rom};
+  for (int chunk{}; chunk < 120; chunk++) {
+    const uint64_t untilCycle{ stepped.cpu.totalCycle + EmuConst::FRAME_CYCLES };
+    while (stepped.cpu.totalCycle < untilCycle)
+      stepped.cpu.executeNextClock();
+
+    cached.cpu.run(untilCycle);
+
+    REQUIRE(cached.cpu.totalCycle == stepped.cpu.totalCycle);
+    REQUIRE(cached.cpu.programCounter == stepped.cpu.programCounter);
+  }
+
+  stepped.cpu.syncPPU();
+  cached.cpu.syncPPU();
+  REQUIRE(cached.cpu.instructionCount == stepped.cpu.instructionCount);
+  REQUIRE(cached.cpu.memory == stepped.cpu.memory);
+  REQUIRE(cached.sink.getFrameCount() == stepped.sink.getFrameCount());
+  REQUIRE(cached.sink.getFrame() == stepped.sink.getFrame());
+  REQUIRE_FALSE(cached.cpu.decodedBlocks.empty());
+}
+
+TEST_CASE("Remapping pages drops the decoded blocks") {
+  Emulator emulator{getTestRomPath("supermariobros.nes")};
+  emulator.cpu.run(emulator.cpu.totalCycle + EmuConst::FRAME_CYCLES);
+  REQUIRE_FALSE(emulator.cpu.decodedBlocks.empty());
+
+  emulator.cpu.mapPages(0xC0, 0x40, &emulator.cpu.prgRom[0x4000], false);
+  REQUIRE(emulator.cpu.decodedBlocks.empty());
+  REQUIRE(emulator.cpu.blockLookup[emulator.cpu.programCounter] == CPU::BLOCK_NOT_DECODED);
+}
+
+TEST_CASE("Idle loops are fast-forwarded without changing the result") {
+  MemorySink steppedSink{};
+  MemorySink cachedSink{};
+  PPU steppedPPU{steppedSink};
+  PPU cachedPPU{cachedSink};
+  InputHandler inputHandler{};
+  CPU stepped{steppedPPU, inputHandler};
+  CPU cached{cachedPPU, inputHandler};
+
+  // $8000: LDA $10, BEQ $8000
+  for (CPU* cpu : {&stepped, &cached}) {
+    cpu->prgRom = std::vector<Byte>(0x8000);
+    const Byte program[]{ 0xA5, 0x10, 0xF0, 0xFC };
+    std::copy(std::begin(program), std::end(program), cpu->prgRom.begin());
+    cpu->mapPages(0x80, 0x80, &cpu->prgRom[0], false);
+    cpu->programCounter = 0x8000;
+  }
+
+  const uint64_t untilCycle{ stepped.totalCycle + 100000 };
+  while (stepped.totalCycle < untilCycle)
+    stepped.executeNextClock();
+  cached.run(untilCycle);
+
+  REQUIRE(cached.skippedCycles > 0);
+  REQUIRE(cached.totalCycle == stepped.totalCycle);
+  REQUIRE(cached.instructionCount == stepped.instructionCount);
+  REQUIRE(cached.programCounter == stepped.programCounter);
+  REQUIRE(cached.accumulator == stepped.accumulator);
+  REQUIRE(cached.zero == stepped.zero);
+}
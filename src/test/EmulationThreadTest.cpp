@@ -0,0 +1,182 @@
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define private public
+#include "test_emulator.h"
+#include "../display/triple_buffer_sink.h"
+#include "../threading/emulation_thread.h"
+#include "../threading/spsc_queue.h"
+#include "../threading/triple_buffer.h"
+
+using namespace std::chrono_literals;
+
+using ThreadedEmulator = BasicEmulator<TripleBufferSink>;
+
+TEST_CASE("The triple buffer hands over the latest published value") {
+  TripleBuffer<int> buffer{};
+  REQUIRE_FALSE(buffer.acquire());
+
+  buffer.getBack() = 1;
+  buffer.publish();
+  buffer.getBack() = 2;
+  buffer.publish();
+  REQUIRE(buffer.acquire());
+  REQUIRE(buffer.getFront() == 2);
+  REQUIRE_FALSE(buffer.acquire());
+  REQUIRE(buffer.getFront() == 2);
+
+  // Values only ever move forward across threads
+  std::thread producer{[&buffer] {
+    for (int value{ 3 }; value <= 100'000; value++) {
+      buffer.getBack() = value;
+      buffer.publish();
+    }
+  }};
+  int last{ 2 };
+  while (last < 100'000) {
+    if (buffer.acquire()) {
+      REQUIRE(buffer.getFront() > last);
+      last = buffer.getFront();
+    }
+  }
+  producer.join();
+}
+
+TEST_CASE("The SPSC queue keeps order and refuses values when full") {
+  SpscQueue<int, 4> queue{};
+  int value{};
+  REQUIRE_FALSE(queue.pop(value));
+
+  REQUIRE(queue.push(1));
+  REQUIRE(queue.push(2));
+  REQUIRE(queue.push(3));
+  REQUIRE_FALSE(queue.push(4));
+  REQUIRE(queue.pop(value));
+  REQUIRE(value == 1);
+  REQUIRE(queue.push(4));
+
+  for (int expected{ 2 }; expected <= 4; expected++) {
+    REQUIRE(queue.pop(value));
+    REQUIRE(value == expected);
+  }
+  REQUIRE_FALSE(queue.pop(value));
+
+  SpscQueue<int, 64> shared{};
+  std::thread producer{[&shared] {
+    for (int next{}; next < 100'000;) {
+      if (shared.push(next))
+        next++;
+    }
+  }};
+  for (int expected{}; expected < 100'000;) {
+    if (shared.pop(value)) {
+      REQUIRE(value == expected);
+      expected++;
+    }
+  }
+  producer.join();
+}
+
+TEST_CASE("Input reaches the emulation thread one change per frame") {
+  const std::string rom{ getTestRomPath("supermariobros.nes") };
+
+  // Press start after a second, then hold right
+  std::vector<Byte> inputs(60, 0);
+  inputs.insert(inputs.end(), 5, Button::START);
+  inputs.insert(inputs.end(), 60, 0);
+  inputs.insert(inputs.end(), 100, Button::RIGHT);
+
+  ThreadedEmulator threaded{rom};
+  EmulationThread emulation{threaded.cpu, threaded.ppu, threaded.inputHandler, PacingMode::NONE};
+  for (size_t frame{}; frame < inputs.size(); frame++)
+    REQUIRE(emulation.pushInput(inputs[frame], frame));
+  emulation.start();
+  while (emulation.getFrameCount() < inputs.size() + 20)
+    std::this_thread::sleep_for(1ms);
+  emulation.stop();
+  const uint64_t frames{ emulation.getFrameCount() };
+
+  // Same frames on this thread, applying the input of every frame before it
+  ThreadedEmulator reference{rom};
+  for (uint64_t frame{}; frame < frames; frame++) {
+    if (frame < inputs.size())
+      reference.inputHandler.setButtons(inputs[frame]);
+    reference.runFrame();
+  }
+
+  REQUIRE(threaded.cpu.totalCycle == reference.cpu.totalCycle);
+  REQUIRE(threaded.cpu.memory == reference.cpu.memory);
+  REQUIRE(threaded.sink.acquireFrame());
+  REQUIRE(reference.sink.acquireFrame());
+  REQUIRE(threaded.sink.getFrame() == reference.sink.getFrame());
+  REQUIRE(emulation.getHostStats().getFrameCount() == frames);
+}
+
+TEST_CASE("Input states piling up are caught up on instead of lagging") {
+  ThreadedEmulator threaded{getTestRomPath("supermariobros.nes")};
+  EmulationThread emulation{threaded.cpu, threaded.ppu, threaded.inputHandler, PacingMode::NONE};
+
+  // All meant for the first frame, as if the thread had been stalled while they came in
+  for (int i{}; i < 100; i++)
+    REQUIRE(emulation.pushInput(i % 2 ? Button::START : Button::A));
+  REQUIRE(emulation.pushInput(Button::RIGHT));
+
+  emulation.start();
+  while (emulation.getFrameCount() < EmulationThread::MAX_INPUT_LAG + 2)
+    std::this_thread::sleep_for(1ms);
+  emulation.stop();
+
+  REQUIRE(threaded.inputHandler.getButtons() == Button::RIGHT);
+}
+
+TEST_CASE("Debug states are published for the frames that were drawn") {
+  const int presentEvery{ GENERATE(1, 3, 1000) };
+  ThreadedEmulator threaded{getTestRomPath("supermariobros.nes")};
+  EmulationThread emulation{threaded.cpu, threaded.ppu, threaded.inputHandler, PacingMode::NONE, presentEvery};
+  emulation.setFastForward(true);
+  emulation.setDebugStateEnabled(true);
+  emulation.start();
+  while (emulation.getFrameCount() < 30)
+    std::this_thread::sleep_for(1ms);
+  emulation.stop();
+
+  // Only the latest state is kept, which has to be that of the last frame drawn
+  const bool isDrawn{ threaded.ppu.getDrawnFrameCount() > 0 };
+  REQUIRE(emulation.acquireDebugState() == isDrawn);
+  if (isDrawn) {
+    PPU copy{threaded.sink};
+    REQUIRE(copy.loadState(emulation.getDebugState()));
+    REQUIRE(copy.frame <= threaded.ppu.frame);
+  }
+}
+
+TEST_CASE("The emulation thread pauses and publishes debug states") {
+  ThreadedEmulator threaded{getTestRomPath("supermariobros.nes")};
+  EmulationThread emulation{threaded.cpu, threaded.ppu, threaded.inputHandler, PacingMode::NONE};
+  emulation.setDebugStateEnabled(true);
+  emulation.start();
+  while (emulation.getFrameCount() < 10)
+    std::this_thread::sleep_for(1ms);
+
+  // The frame being emulated is finished before pausing
+  emulation.setPaused(true);
+  uint64_t pausedAt{ emulation.getFrameCount() };
+  do {
+    pausedAt = emulation.getFrameCount();
+    std::this_thread::sleep_for(100ms);
+  } while (emulation.getFrameCount() != pausedAt);
+  std::this_thread::sleep_for(100ms);
+  REQUIRE(emulation.getFrameCount() == pausedAt);
+
+  REQUIRE(emulation.acquireDebugState());
+  PPU copy{threaded.sink};
+  REQUIRE(copy.loadState(emulation.getDebugState()));
+
+  emulation.setPaused(false);
+  while (emulation.getFrameCount() < pausedAt + 10)
+    std::this_thread::sleep_for(1ms);
+  emulation.stop();
+}
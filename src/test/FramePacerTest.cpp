@@ -0,0 +1,110 @@
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "../frame_pacer/frame_pacer.h"
+
+using namespace std::chrono_literals;
+
+static double getElapsedMilliseconds(FramePacer::Clock::time_point from) {
+  return std::chrono::duration<double, std::milli>(FramePacer::Clock::now() - from).count();
+}
+
+TEST_CASE("Frames are kept to the frame rate") {
+  HostStats stats{};
+  FramePacer pacer{PacingMode::TIMER, 100.0};
+  pacer.setHostStats(&stats);
+
+  const FramePacer::Clock::time_point start{ FramePacer::Clock::now() };
+  for (int frame{}; frame < 30; frame++) {
+    // Emulating takes a varying part of the frame, the schedule does not depend on it
+    std::this_thread::sleep_for(std::chrono::milliseconds{frame % 5});
+    pacer.waitForNextFrame();
+  }
+
+  const double elapsed{ getElapsedMilliseconds(start) };
+  REQUIRE(elapsed >= 300.0);
+  REQUIRE(elapsed < 400.0);
+  REQUIRE(stats.getPacedFrameCount() == 30);
+  REQUIRE(stats.getNanoseconds(Subsystem::PACING) > 100'000'000);
+
+  std::ostringstream json{};
+  stats.writeJSON(json);
+  REQUIRE(json.str().find("\"paced_frames\": 30,") != std::string::npos);
+  REQUIRE(json.str().find("\"pacing\": ") != std::string::npos);
+}
+
+TEST_CASE("A frame late by more than a frame starts the schedule over") {
+  HostStats stats{};
+  FramePacer pacer{PacingMode::TIMER, 100.0};
+  pacer.setHostStats(&stats);
+
+  pacer.waitForNextFrame();
+  std::this_thread::sleep_for(50ms);
+  pacer.waitForNextFrame();
+  REQUIRE(stats.getMissedDeadlines() == 1);
+  REQUIRE(stats.getMaxDrift() > 30.0);
+
+  // The frames after it are not rushed to catch up
+  const FramePacer::Clock::time_point start{ FramePacer::Clock::now() };
+  pacer.waitForNextFrame();
+  pacer.waitForNextFrame();
+  REQUIRE(getElapsedMilliseconds(start) >= 19.0);
+}
+
+TEST_CASE("Only the timer mode waits") {
+  HostStats stats{};
+  FramePacer pacer{PacingMode::VSYNC, 100.0};
+  pacer.setHostStats(&stats);
+
+  const FramePacer::Clock::time_point start{ FramePacer::Clock::now() };
+  for (int frame{}; frame < 5; frame++)
+    pacer.waitForNextFrame();
+  REQUIRE(getElapsedMilliseconds(start) < 40.0);
+  REQUIRE(stats.getPacedFrameCount() == 5);
+
+  // Frames done early count as drift too
+  REQUIRE(stats.getMeanDrift() > 0.0);
+
+  pacer.setMode(PacingMode::NONE);
+  for (int frame{}; frame < 5; frame++)
+    pacer.waitForNextFrame();
+  REQUIRE(stats.getPacedFrameCount() == 5);
+  REQUIRE(pacer.getMode() == PacingMode::NONE);
+}
+
+TEST_CASE("Fast forward presents every nth frame") {
+  FastForward fastForward{4};
+  for (int frame{ 1 }; frame <= 12; frame++)
+    REQUIRE(fastForward.isNextFramePresented() == (frame % 4 == 0));
+}
+
+TEST_CASE("Fast forward presents at most at the present rate") {
+  FastForward fastForward{0, 100.0};
+  REQUIRE(fastForward.isNextFramePresented());
+
+  int presented{};
+  const FramePacer::Clock::time_point start{ FramePacer::Clock::now() };
+  while (getElapsedMilliseconds(start) < 100.0) {
+    if (fastForward.isNextFramePresented())
+      presented++;
+  }
+  REQUIRE(presented >= 5);
+  REQUIRE(presented <= 11);
+}
+
+TEST_CASE("Fast forward measures the speed over every interval") {
+  FastForward fastForward{};
+  REQUIRE_FALSE(fastForward.endFrame(29781));
+
+  // 10 seconds of emulation in about half a second
+  std::this_thread::sleep_for(FastForward::SPEED_INTERVAL);
+  REQUIRE(fastForward.endFrame(10 * 1789773 - 29781));
+  REQUIRE(fastForward.getSpeed() > 15.0);
+  REQUIRE(fastForward.getSpeed() <= 20.0);
+
+  fastForward.reset();
+  REQUIRE(fastForward.getSpeed() == 0.0);
+}
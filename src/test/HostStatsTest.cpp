@@ -0,0 +1,62 @@
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#define private public
+#include "../stats/host_stats.h"
+
+TEST_CASE("Subsystem time is exclusive of the subsystems entered from it") {
+  using namespace std::chrono_literals;
+  HostStats stats{};
+
+  {
+    HostStats::Scope cpu{&stats, Subsystem::CPU};
+    std::this_thread::sleep_for(5ms);
+    {
+      HostStats::Scope ppu{&stats, Subsystem::PPU};
+      std::this_thread::sleep_for(20ms);
+    }
+  }
+
+  REQUIRE(stats.getNanoseconds(Subsystem::PPU) >= 20'000'000);
+  REQUIRE(stats.getNanoseconds(Subsystem::CPU) >= 5'000'000);
+  REQUIRE(stats.getNanoseconds(Subsystem::CPU) < 20'000'000);
+  REQUIRE(stats.depth == 0);
+
+  // A null scope does nothing
+  HostStats::Scope none{nullptr, Subsystem::EVENTS};
+  REQUIRE(stats.getNanoseconds(Subsystem::EVENTS) == 0);
+}
+
+TEST_CASE("Frame time percentiles are read from the histogram") {
+  HostStats stats{};
+  REQUIRE(stats.getFrameTimePercentile(50) == 0.0);
+
+  // 90 frames of 16.x ms, 9 of 20.x ms, 1 over the histogram
+  stats.frameTimeBuckets[160] = 90;
+  stats.frameTimeBuckets[200] = 9;
+  stats.frameTimeBuckets[HostStats::BUCKET_COUNT - 1] = 1;
+  stats.frameCount = 100;
+  stats.hostNanoseconds = 2'000'000'000;
+  stats.emulatedCycles = 2 * 1789773;
+
+  CHECK(stats.getFrameTimePercentile(50) == Catch::Approx(16.1));
+  CHECK(stats.getFrameTimePercentile(95) == Catch::Approx(20.1));
+  CHECK(stats.getFrameTimePercentile(99) == Catch::Approx(20.1));
+  CHECK(stats.getFrameTimePercentile(100) == Catch::Approx(100.0));
+  CHECK(stats.getEmulatedFPS() == Catch::Approx(50.0));
+  CHECK(stats.getSpeed() == Catch::Approx(1.0));
+
+  std::ostringstream json{};
+  stats.writeJSON(json);
+  CHECK(json.str().find("\"frames\": 100,") != std::string::npos);
+  CHECK(json.str().find("\"p95\": 20.1") != std::string::npos);
+  CHECK(json.str().find("\"debug_display\": 0") != std::string::npos);
+
+  stats.endFrame(29834);
+  REQUIRE(stats.getFrameCount() == 101);
+  stats.reset();
+  REQUIRE(stats.getFrameCount() == 0);
+}
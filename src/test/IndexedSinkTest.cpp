@@ -0,0 +1,64 @@
+#include <catch2/catch_all.hpp>
+#include <string>
+#include <vector>
+
+#define private public
+#include "test_emulator.h"
+#include "../display/indexed_sink.h"
+#include "../simd.h"
+
+TEST_CASE("Converted indexed frames are the same as ARGB frames") {
+  const std::string rom{ getTestRomPath(GENERATE(from_range(RENDER_TEST_ROMS))) };
+
+  Emulator argb{rom};
+  BasicEmulator<IndexedSink> indexed{rom};
+  const Palette palette{};
+  std::vector<uint32_t> converted{};
+  for (int frame{}; frame < 120; frame++) {
+    const uint64_t untilCycle{ argb.cpu.totalCycle + EmuConst::FRAME_CYCLES };
+    argb.cpu.run(untilCycle);
+    indexed.cpu.run(untilCycle);
+
+    REQUIRE(indexed.sink.getFrameCount() == argb.sink.getFrameCount());
+    if (indexed.sink.getFrameCount() > 0) {
+      indexed.sink.convertFrame(palette, converted);
+      REQUIRE(converted == argb.sink.getFrame());
+    }
+  }
+}
+
+TEST_CASE("Indexed pixels keep the colour emphasis") {
+  IndexedSink sink{};
+  sink.drawPixel(0, 0, 0x16, 0b1010'0000);
+  std::vector<Byte> line(EmuConst::SCREEN_WIDTH, 0x2A);
+  sink.drawScanline(1, line.data(), 0b0100'0001);
+  sink.updateScreen();
+
+  REQUIRE(sink.getFrame()[0] == (0x16 | 0b101 << 6));
+  REQUIRE(sink.getFrame()[EmuConst::SCREEN_WIDTH + 100] == (0x2A | 0b010 << 6));
+
+  const Palette palette{};
+  std::vector<uint32_t> converted{};
+  sink.convertFrame(palette, converted);
+  REQUIRE(converted[0] == convertToARGB(0x16, 0b1010'0000));
+  REQUIRE(converted[EmuConst::SCREEN_WIDTH + 100] == convertToARGB(0x2A, 0b0100'0000));
+}
+
+TEST_CASE("Indexed conversion kernels agree") {
+  if (getSupportedSimdLevel() != SimdLevel::AVX2) {
+    WARN("AVX2 is not supported, only the scalar kernel runs");
+    return;
+  }
+
+  const Palette palette{};
+  std::vector<uint16_t> pixels(1027);
+  for (size_t i{}; i < pixels.size(); i++)
+    pixels[i] = static_cast<uint16_t>(i * 7 + (i >> 3)); // Bits above bit 8 must be ignored
+
+  std::vector<uint32_t> scalar(pixels.size());
+  std::vector<uint32_t> avx2(pixels.size());
+  convertIndexedScalar(pixels.data(), pixels.size(), palette.getIndexedTable(), scalar.data());
+  convertIndexedAVX2(pixels.data(), pixels.size(), palette.getIndexedTable(), avx2.data());
+  REQUIRE(avx2 == scalar);
+  REQUIRE(scalar[3] == palette.convert(21, 0));
+}
@@ -0,0 +1,134 @@
+#include <catch2/catch_all.hpp>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#define private public
+#include "test_emulator.h"
+#include "../ppu/compose.h"
+#include "../display/null_sink.h"
+#include "../display/palette.h"
+#include "../simd.h"
+
+using ComposeKernel = bool (*)(const Byte*, const Byte*, const Byte*, Byte, Byte*);
+using ConvertKernel = void (*)(const Byte*, const uint32_t*, uint32_t*);
+
+// Kernels above the host's level are skipped rather than run into an illegal instruction
+static std::vector<SimdLevel> getTestedLevels() {
+  std::vector<SimdLevel> levels{};
+  for (SimdLevel level : { SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2 })
+    if (level <= getSupportedSimdLevel())
+      levels.push_back(level);
+  return levels;
+}
+
+static ComposeKernel getComposeKernel(SimdLevel level) {
+  switch (level) {
+    case SimdLevel::AVX2:
+      return composeLineAVX2;
+    case SimdLevel::SSE2:
+      return composeLineSSE2;
+    default:
+      return composeLineScalar;
+  }
+}
+
+TEST_CASE("Every compose kernel matches PPU::composePixel") {
+  NullSink sink{};
+  PPU ppu{sink};
+  std::mt19937 random{ 2024 };
+
+  std::array<Byte, 0x20> palette;
+  for (int i{}; i < 0x20; i++)
+    palette[i] = random() & 0x3F;
+
+  for (SimdLevel level : getTestedLevels()) {
+    INFO(getSimdLevelName(level));
+    const ComposeKernel kernel{ getComposeKernel(level) };
+
+    // Only bit 1 to bit 4 of PPUMASK change the composition
+    for (int mask{}; mask < 0x20; mask += 0b10) {
+      for (int round{}; round < 64; round++) {
+        std::array<Byte, EmuConst::SCREEN_WIDTH> background;
+        std::array<Byte, EmuConst::SCREEN_WIDTH> sprites;
+        for (int column{}; column < EmuConst::SCREEN_WIDTH; column++) {
+          background[column] = random() & 0x0F;
+          // Sprite PixelData is either 0 or has bit 7 and bit 4 set
+          sprites[column] = random() % 4 == 0 ? 0 : (random() & 0x6F) | 0x90;
+        }
+
+        ppu.ppuMask = mask;
+        ppu.ppuStatus = 0;
+        std::array<Byte, EmuConst::SCREEN_WIDTH> expected;
+        for (int column{}; column < EmuConst::SCREEN_WIDTH; column++)
+          expected[column] = palette[ppu.composePixel(column, background[column], sprites[column])];
+
+        std::array<Byte, EmuConst::SCREEN_WIDTH> line;
+        const bool sprite0Hit{ kernel(background.data(), sprites.data(), palette.data(), mask, line.data()) };
+        REQUIRE(line == expected);
+        REQUIRE(sprite0Hit == ((ppu.ppuStatus & 0b0100'0000) != 0));
+      }
+    }
+  }
+}
+
+TEST_CASE("Every convert kernel matches convertToARGB") {
+  const Palette palette{};
+  std::array<Byte, EmuConst::SCREEN_WIDTH> colorIndices;
+  for (int x{}; x < EmuConst::SCREEN_WIDTH; x++)
+    colorIndices[x] = (x * 37) & 0x3F;
+
+  for (SimdLevel level : getTestedLevels()) {
+    INFO(getSimdLevelName(level));
+    const ConvertKernel kernel{ level == SimdLevel::AVX2 ? convertLineAVX2 : convertLineScalar };
+
+    for (int emphasis{}; emphasis < 8; emphasis++) {
+      const Byte mask{ static_cast<Byte>(emphasis << 5 | 0b1'1110) };
+      std::array<uint32_t, EmuConst::SCREEN_WIDTH> line;
+      kernel(colorIndices.data(), palette.getTable(mask), line.data());
+      for (int x{}; x < EmuConst::SCREEN_WIDTH; x++)
+        REQUIRE(line[x] == convertToARGB(colorIndices[x], mask));
+    }
+  }
+}
+
+TEST_CASE("SIMD line kernels render every test ROM exactly like the scalar ones") {
+  const SimdLevel best{ getSupportedSimdLevel() };
+  if (best == SimdLevel::SCALAR) {
+    WARN("The host has no SIMD kernels");
+    return;
+  }
+
+  for (const auto& entry : std::filesystem::directory_iterator{TEST_ROM_DIR}) {
+    const std::string rom{ entry.path().string() };
+    INFO(rom);
+
+    Emulator scalar{};
+    Emulator simd{};
+    Initializer scalarInitializer{scalar.cpu, scalar.ppu};
+    Initializer simdInitializer{simd.cpu, simd.ppu};
+    // ROMs using a mapper the emulator does not support yet are not rendered at all
+    if (!scalarInitializer.loadFile(rom).empty())
+      continue;
+    REQUIRE(simdInitializer.loadFile(rom).empty());
+    scalar.cpu.executeStartUpSequence();
+    simd.cpu.executeStartUpSequence();
+
+    for (int frame{}; frame < 120; frame++) {
+      const uint64_t untilCycle{ scalar.cpu.totalCycle + EmuConst::FRAME_CYCLES };
+      setSimdLevel(SimdLevel::SCALAR);
+      scalar.cpu.run(untilCycle);
+      scalar.cpu.syncPPU();
+      setSimdLevel(best);
+      simd.cpu.run(untilCycle);
+      simd.cpu.syncPPU();
+
+      REQUIRE(simd.ppu.ppuStatus == scalar.ppu.ppuStatus);
+      REQUIRE(simd.sink.getFrameCount() == scalar.sink.getFrameCount());
+      REQUIRE(simd.sink.getFrame() == scalar.sink.getFrame());
+    }
+  }
+
+  setSimdLevel(best);
+}
@@ -0,0 +1,78 @@
+#include <catch2/catch_all.hpp>
+
+#define private public
+#include "../ppu/ppu.h"
+#include "../display/null_sink.h"
+
+// 1 KB slot of nametable memory the nametable uses, per mirroring
+static int getExpectedSlot(Mirroring mirroring, int nametable) {
+  switch (mirroring) {
+    case Mirroring::HORIZONTAL:
+      return nametable / 2;
+    case Mirroring::VERTICAL:
+      return nametable % 2;
+    case Mirroring::SINGLE_LOW:
+      return 0;
+    case Mirroring::SINGLE_HIGH:
+      return 1;
+    default:
+      return nametable;
+  }
+}
+
+TEST_CASE("Nametables alias according to the mirroring") {
+  const Mirroring mirroring{ GENERATE(Mirroring::HORIZONTAL, Mirroring::VERTICAL, Mirroring::SINGLE_LOW,
+                                      Mirroring::SINGLE_HIGH, Mirroring::FOUR_SCREEN) };
+  NullSink sink{};
+  PPU ppu{sink};
+  ppu.setMirroring(mirroring);
+
+  for (int nametable{}; nametable < 4; nametable++)
+    ppu.writeMemory(0x2000 + nametable * 0x400 + 0x123, nametable + 1);
+
+  for (int nametable{}; nametable < 4; nametable++) {
+    // The last write to any of the nametables sharing a slot is what all of them read
+    int expected{};
+    for (int other{}; other < 4; other++) {
+      if (getExpectedSlot(mirroring, other) == getExpectedSlot(mirroring, nametable))
+        expected = other + 1;
+    }
+    REQUIRE(ppu.readMemory(0x2000 + nametable * 0x400 + 0x123) == expected);
+    REQUIRE(ppu.readMemory(0x3000 + nametable * 0x400 + 0x123) == expected);
+  }
+}
+
+TEST_CASE("Switching the mirroring keeps the nametable memory") {
+  NullSink sink{};
+  PPU ppu{sink};
+  ppu.setMirroring(Mirroring::VERTICAL);
+  ppu.writeMemory(0x2000, 0xAA);
+  ppu.writeMemory(0x2400, 0xBB);
+
+  ppu.setMirroring(Mirroring::HORIZONTAL);
+  REQUIRE(ppu.readMemory(0x2400) == 0xAA);
+  REQUIRE(ppu.readMemory(0x2800) == 0xBB);
+
+  ppu.setMirroring(Mirroring::SINGLE_HIGH);
+  REQUIRE(ppu.readMemory(0x2000) == 0xBB);
+  REQUIRE(ppu.readMemory(0x2C00) == 0xBB);
+}
+
+TEST_CASE("Palette mirrors are resolved when written") {
+  NullSink sink{};
+  PPU ppu{sink};
+
+  for (int i{}; i < 0x20; i++)
+    ppu.writeMemory(0x3F00 + i, i);
+
+  for (int i{}; i < 0x20; i++) {
+    // $3F10, $3F14, $3F18 and $3F1C were written last, over $3F00, $3F04, $3F08 and $3F0C
+    const int expected{ (i & 0b11) == 0 ? (i | 0x10) : i };
+    REQUIRE(ppu.readMemory(0x3F00 + i) == expected);
+    REQUIRE(ppu.readMemory(0x3FE0 + i) == expected);
+  }
+
+  ppu.writeMemory(0x3F00, 0x0F);
+  REQUIRE(ppu.readMemory(0x3F10) == 0x0F);
+  REQUIRE(ppu.readMemory(0x3F01) == 0x01);
+}
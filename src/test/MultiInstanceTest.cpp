@@ -0,0 +1,49 @@
+#include <catch2/catch_all.hpp>
+#include <string>
+#include <vector>
+
+#include "test_emulator.h"
+
+/**
+ * \brief Execute one instruction, appending the frame to frames if the PPU completed one
+ */
+static void step(Emulator& emulator, std::vector<std::vector<uint32_t>>& frames) {
+  emulator.cpu.executeNextClock();
+  if (emulator.sink.getFrameCount() > frames.size())
+    frames.push_back(emulator.sink.getFrame());
+}
+
+static std::vector<std::vector<uint32_t>> runSolo(const std::string& romPath, std::size_t frameCount) {
+  Emulator emulator{romPath};
+  std::vector<std::vector<uint32_t>> frames{};
+  while (frames.size() < frameCount)
+    step(emulator, frames);
+  return frames;
+}
+
+TEST_CASE("Two emulators in one process do not affect each other") {
+  const std::string romA{ getTestRomPath("supermariobros.nes") };
+  const std::string romB{ getTestRomPath("pacman.nes") };
+  constexpr std::size_t frameCount{ 120 };
+
+  const std::vector<std::vector<uint32_t>> soloA{ runSolo(romA, frameCount) };
+  const std::vector<std::vector<uint32_t>> soloB{ runSolo(romB, frameCount) };
+  REQUIRE(soloA.back() != soloB.back());
+
+  // Alternate between the two an instruction at a time so that any state shared between instances leaks across
+  Emulator emulatorA{romA};
+  Emulator emulatorB{romB};
+  std::vector<std::vector<uint32_t>> framesA{};
+  std::vector<std::vector<uint32_t>> framesB{};
+  while (framesA.size() < frameCount || framesB.size() < frameCount) {
+    if (framesA.size() < frameCount)
+      step(emulatorA, framesA);
+    if (framesB.size() < frameCount)
+      step(emulatorB, framesB);
+  }
+
+  for (std::size_t i{}; i < frameCount; i++) {
+    REQUIRE(framesA[i] == soloA[i]);
+    REQUIRE(framesB[i] == soloB[i]);
+  }
+}
@@ -5,11 +5,12 @@
 
 #define private public
 #include "../ppu/ppu.h"
+#include "../display/null_sink.h"
 #include "../utils.h"
 
 TEST_CASE("PPU Registers function correctly") {
-  Display display{nullptr, nullptr};
-  PPU ppu{display};
+  NullSink sink{};
+  PPU ppu{sink};
   uint8_t input = GENERATE(0, 25, 66, 78, 126, 234, 255);
 
   SECTION("PPUCTRL") {
@@ -96,7 +97,7 @@ TEST_CASE("PPU Registers function correctly") {
       cpuMem[i] = 0xff;
     }
 
-    ppu.writeOAMDma(cpuMem, 0x02);
+    ppu.writeOAMDma(&cpuMem[0x200]);
     for (int i{}; i < 256; i++) {
       REQUIRE(ppu.oam[i] == 0xff);
     }
@@ -104,8 +105,8 @@ TEST_CASE("PPU Registers function correctly") {
 }
 
 TEST_CASE("PPU Sprite Evaluation Routine Work Correctly") {
-  Display display{nullptr, nullptr};
-  PPU ppu{display};
+  NullSink sink{};
+  PPU ppu{sink};
   for (int i{}; i < 64; i++) {
     ppu.oam[i * 4 + 3] = i;
   }
@@ -0,0 +1,77 @@
+#include <catch2/catch_all.hpp>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "../display/palette.h"
+
+TEST_CASE("Default palette matches convertToARGB") {
+  const Palette palette{};
+  for (int ppuMask{}; ppuMask < 0x100; ppuMask++) {
+    const uint32_t* table{ palette.getTable(ppuMask) };
+    for (int colorIndex{}; colorIndex < Palette::COLOR_COUNT; colorIndex++) {
+      REQUIRE(table[colorIndex] == convertToARGB(colorIndex, ppuMask));
+      REQUIRE(palette.convert(colorIndex, ppuMask) == convertToARGB(colorIndex, ppuMask));
+    }
+  }
+}
+
+TEST_CASE("The indexed table holds every emphasis combination in one array") {
+  const Palette palette{};
+  const uint32_t* table{ palette.getIndexedTable() };
+  for (int pixel{}; pixel < Palette::EMPHASIS_COUNT * Palette::COLOR_COUNT; pixel++)
+    REQUIRE(table[pixel] == palette.convert(pixel & 0x3F, (pixel >> 6) << 5));
+}
+
+TEST_CASE("Loading a 64 colour palette derives the emphasised colours") {
+  std::vector<Byte> data(Palette::COLOR_COUNT * 3);
+  for (int i{}; i < Palette::COLOR_COUNT; i++) {
+    data[i * 3] = 0xF0;
+    data[i * 3 + 1] = i * 4;
+    data[i * 3 + 2] = 0x30;
+  }
+
+  Palette palette{};
+  REQUIRE(palette.loadData(data).empty());
+  REQUIRE(palette.convert(5, 0) == 0xFFF01430);
+  REQUIRE(palette.convert(0x45, 0) == 0xFFF01430);
+
+  // Red emphasis keeps red and dims green and blue to 2/3
+  REQUIRE(palette.convert(0x30, 0b0010'0000) == 0xFFF08020);
+
+  palette.reset();
+  REQUIRE(palette.convert(0x30, 0) == convertToARGB(0x30, 0));
+}
+
+TEST_CASE("Loading a palette with every emphasis combination uses it as is") {
+  std::vector<Byte> data(Palette::EMPHASIS_COUNT * Palette::COLOR_COUNT * 3);
+  for (int emphasis{}; emphasis < Palette::EMPHASIS_COUNT; emphasis++) {
+    for (int i{}; i < Palette::COLOR_COUNT; i++) {
+      const int offset{ (emphasis * Palette::COLOR_COUNT + i) * 3 };
+      data[offset] = emphasis;
+      data[offset + 1] = i;
+      data[offset + 2] = 0xAB;
+    }
+  }
+
+  const std::filesystem::path path{ std::filesystem::temp_directory_path() / "nesemulator_palette_test.pal" };
+  {
+    std::ofstream file{ path, std::ios_base::binary };
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+  }
+
+  Palette palette{};
+  REQUIRE(palette.loadFile(path.string()).empty());
+  std::filesystem::remove(path);
+
+  for (int emphasis{}; emphasis < Palette::EMPHASIS_COUNT; emphasis++)
+    for (int i{}; i < Palette::COLOR_COUNT; i++)
+      REQUIRE(palette.convert(i, emphasis << 5 | 0b1'1110) == (0xFF0000AB | emphasis << 16 | i << 8));
+}
+
+TEST_CASE("Palettes of the wrong size are rejected") {
+  Palette palette{};
+  REQUIRE_FALSE(palette.loadData(std::vector<Byte>(100)).empty());
+  REQUIRE_FALSE(palette.loadFile("no_such_file.pal").empty());
+  REQUIRE(palette.convert(0x30, 0) == convertToARGB(0x30, 0));
+}
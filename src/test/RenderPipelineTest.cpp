@@ -0,0 +1,116 @@
+#include <catch2/catch_all.hpp>
+#include <array>
+#include <memory>
+#include <string>
+
+#define private public
+#include "test_emulator.h"
+#include "../ppu/render_pipeline.h"
+
+TEST_CASE("Pipelined frames are the same as frames drawn inline") {
+  const std::string rom{ getTestRomPath(GENERATE(from_range(RENDER_TEST_ROMS))) };
+
+  Emulator inlined{rom};
+  Emulator pipelined{rom};
+  MemorySink pipelineSink{};
+  RenderPipeline pipeline{pipelined.ppu, pipelineSink};
+
+  for (int frame{}; frame < 180; frame++) {
+    inlined.runFrame();
+    pipelined.runFrame();
+    pipeline.flush();
+
+    REQUIRE(pipelined.cpu.memory == inlined.cpu.memory);
+    REQUIRE(pipelineSink.getFrameCount() == inlined.sink.getFrameCount());
+    REQUIRE(pipelineSink.getFrame() == inlined.sink.getFrame());
+  }
+
+  REQUIRE(pipelined.sink.getFrameCount() == 0);
+  REQUIRE(pipeline.getFrameCount() > 170);
+}
+
+TEST_CASE("Attaching and detaching a pipeline mid-frame does not change the frames") {
+  Emulator inlined{getTestRomPath("supermariobros.nes")};
+  Emulator pipelined{getTestRomPath("supermariobros.nes")};
+
+  std::unique_ptr<RenderPipeline> pipeline{};
+  for (int frame{}; frame < 120; frame++) {
+    const uint64_t untilCycle{ inlined.cpu.totalCycle + EmuConst::FRAME_CYCLES };
+    inlined.cpu.run(untilCycle);
+    inlined.cpu.syncPPU();
+
+    // Switch halfway through the chunk, which falls at a different scanline every time
+    pipelined.cpu.run(untilCycle - 15000);
+    pipelined.cpu.syncPPU();
+    if (frame % 20 == 10)
+      pipeline = std::make_unique<RenderPipeline>(pipelined.ppu, pipelined.sink);
+    else if (frame % 20 == 0)
+      pipeline.reset();
+    pipelined.cpu.run(untilCycle);
+    pipelined.cpu.syncPPU();
+    if (pipeline)
+      pipeline->flush();
+
+    REQUIRE(pipelined.sink.getFrameCount() == inlined.sink.getFrameCount());
+    REQUIRE(pipelined.sink.getFrame() == inlined.sink.getFrame());
+  }
+}
+
+TEST_CASE("Pipelined frames follow render skipping and mirroring changes") {
+  const std::string rom{ getTestRomPath(GENERATE(from_range(RENDER_TEST_ROMS))) };
+
+  Emulator inlined{rom};
+  Emulator pipelined{rom};
+  MemorySink pipelineSink{};
+  RenderPipeline pipeline{pipelined.ppu, pipelineSink};
+
+  constexpr std::array<Mirroring, 4> MIRRORINGS{
+    Mirroring::VERTICAL, Mirroring::SINGLE_LOW, Mirroring::HORIZONTAL, Mirroring::SINGLE_HIGH
+  };
+  for (int frame{}; frame < 120; frame++) {
+    // Both change halfway through the chunk, where a mapper would
+    const uint64_t untilCycle{ inlined.cpu.totalCycle + EmuConst::FRAME_CYCLES };
+    for (Emulator* emulator : {&inlined, &pipelined}) {
+      emulator->cpu.run(untilCycle - 15000);
+      emulator->cpu.syncPPU();
+      emulator->ppu.setRenderEnabled(frame % 10 < 6);
+      if (frame % 15 == 0)
+        emulator->ppu.setMirroring(MIRRORINGS[frame / 15 % MIRRORINGS.size()]);
+      emulator->cpu.run(untilCycle);
+      emulator->cpu.syncPPU();
+    }
+    pipeline.flush();
+
+    REQUIRE(pipelined.cpu.memory == inlined.cpu.memory);
+    REQUIRE(pipelineSink.getFrameCount() == inlined.sink.getFrameCount());
+    REQUIRE(pipelineSink.getFrame() == inlined.sink.getFrame());
+  }
+
+  REQUIRE(pipelineSink.getFrameCount() < pipeline.getFrameCount());
+  REQUIRE(pipelined.sink.getFrameCount() == 0);
+}
+
+TEST_CASE("Loading a saved PPU state restores it exactly") {
+  Emulator emulator{getTestRomPath("supermariobros.nes")};
+  for (int frame{}; frame < 40; frame++)
+    emulator.runFrame();
+
+  std::vector<Byte> saved{};
+  emulator.ppu.saveState(saved);
+
+  MemorySink sink{};
+  PPU copy{sink};
+  REQUIRE(copy.loadState(saved));
+
+  std::vector<Byte> copied{};
+  copy.saveState(copied);
+  REQUIRE(copied == saved);
+
+  // The copy carries on from the same position
+  copy.runUntil(emulator.ppu.clock + 262 * 341);
+  REQUIRE(copy.frame == emulator.ppu.frame + 1);
+  REQUIRE(sink.getFrameCount() == 1);
+
+  saved.pop_back();
+  REQUIRE_FALSE(copy.loadState(saved));
+}
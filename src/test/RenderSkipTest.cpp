@@ -0,0 +1,57 @@
+#include <catch2/catch_all.hpp>
+#include <string>
+
+#define private public
+#include "test_emulator.h"
+
+TEST_CASE("Frames that are not drawn run the emulated program exactly the same") {
+  const std::string rom{ getTestRomPath(GENERATE(from_range(RENDER_TEST_ROMS))) };
+  const bool useScanlineRenderer{ GENERATE(true, false) };
+
+  Emulator drawn{rom};
+  Emulator skipped{rom};
+  drawn.ppu.setScanlineRenderer(useScanlineRenderer);
+  skipped.ppu.setScanlineRenderer(useScanlineRenderer);
+  skipped.ppu.setRenderEnabled(false);
+  for (int frame{}; frame < 180; frame++) {
+    drawn.runFrame();
+    skipped.runFrame();
+
+    REQUIRE(skipped.cpu.totalCycle == drawn.cpu.totalCycle);
+    REQUIRE(skipped.ppu.clock == drawn.ppu.clock);
+    REQUIRE(skipped.ppu.ppuStatus == drawn.ppu.ppuStatus);
+    REQUIRE(skipped.ppu.v == drawn.ppu.v);
+    REQUIRE(skipped.ppu.oam.oamAddr == drawn.ppu.oam.oamAddr);
+    REQUIRE(skipped.ppu.oam.spritePixelData == drawn.ppu.oam.spritePixelData);
+    REQUIRE(skipped.cpu.memory == drawn.cpu.memory);
+  }
+
+  REQUIRE(drawn.sink.getFrameCount() > 170);
+  REQUIRE(skipped.sink.getFrameCount() == 0);
+}
+
+TEST_CASE("Render skipping takes effect at the start of the next frame") {
+  Emulator emulator{getTestRomPath("supermariobros.nes")};
+  for (int frame{}; frame < 60; frame++)
+    emulator.runFrame();
+  const uint64_t drawnFrames{ emulator.sink.getFrameCount() };
+
+  // Switching off in the middle of a frame still draws that frame
+  while (emulator.ppu.scanline != 120) {
+    emulator.cpu.run(emulator.cpu.totalCycle + 1);
+    emulator.cpu.syncPPU();
+  }
+  emulator.ppu.setRenderEnabled(false);
+  for (int frame{}; frame < 60; frame++)
+    emulator.runFrame();
+  REQUIRE(emulator.sink.getFrameCount() == drawnFrames + 1);
+  REQUIRE(emulator.ppu.getDrawnFrameCount() == emulator.sink.getFrameCount());
+
+  // Back on, the following frames are drawn from the top
+  emulator.ppu.setRenderEnabled(true);
+  for (int frame{}; frame < 3; frame++)
+    emulator.runFrame();
+  REQUIRE(emulator.sink.getFrameCount() >= drawnFrames + 3);
+  REQUIRE(emulator.ppu.getDrawnFrameCount() == emulator.sink.getFrameCount());
+  REQUIRE(emulator.sink.getFrame() != std::vector<uint32_t>(EmuConst::SCREEN_WIDTH * EmuConst::SCREEN_HEIGHT));
+}
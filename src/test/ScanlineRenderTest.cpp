@@ -0,0 +1,29 @@
+#include <catch2/catch_all.hpp>
+#include <string>
+
+#define private public
+#include "test_emulator.h"
+
+TEST_CASE("Rendering whole scanlines matches rendering dot by dot") {
+  const std::string rom{ getTestRomPath(GENERATE(from_range(RENDER_TEST_ROMS))) };
+
+  Emulator dots{rom};
+  Emulator scanlines{rom};
+  dots.ppu.useScanlineRenderer = false;
+  scanlines.ppu.useScanlineRenderer = true;
+  for (int frame{}; frame < 180; frame++) {
+    dots.runFrame();
+    scanlines.runFrame();
+
+    REQUIRE(scanlines.cpu.totalCycle == dots.cpu.totalCycle);
+    REQUIRE(scanlines.ppu.clock == dots.ppu.clock);
+    REQUIRE(scanlines.ppu.ppuStatus == dots.ppu.ppuStatus);
+    REQUIRE(scanlines.ppu.v == dots.ppu.v);
+    REQUIRE(scanlines.ppu.oam.oamAddr == dots.ppu.oam.oamAddr);
+    REQUIRE(scanlines.ppu.oam.spritePixelData == dots.ppu.oam.spritePixelData);
+    REQUIRE(scanlines.sink.getFrameCount() == dots.sink.getFrameCount());
+    REQUIRE(scanlines.sink.getFrame() == dots.sink.getFrame());
+  }
+
+  REQUIRE(scanlines.cpu.memory == dots.cpu.memory);
+}
@@ -0,0 +1,27 @@
+#include <catch2/catch_all.hpp>
+
+#include "../scheduler/scheduler.h"
+
+TEST_CASE("Scheduler tracks the earliest pending event") {
+  Scheduler scheduler{};
+  REQUIRE(scheduler.getNextEventTime() == Scheduler::NEVER);
+
+  scheduler.schedule(EventType::VBLANK_END, 500);
+  scheduler.schedule(EventType::VBLANK_START, 200);
+  REQUIRE(scheduler.getNextEventTime() == 200);
+  REQUIRE(scheduler.isDue(EventType::VBLANK_START, 200));
+  REQUIRE_FALSE(scheduler.isDue(EventType::VBLANK_END, 200));
+
+  SECTION("Rescheduling replaces the pending event of that type") {
+    scheduler.schedule(EventType::VBLANK_START, 900);
+    REQUIRE(scheduler.getEventTime(EventType::VBLANK_START) == 900);
+    REQUIRE(scheduler.getNextEventTime() == 500);
+  }
+
+  SECTION("Cancelled events are never due") {
+    scheduler.cancel(EventType::VBLANK_START);
+    scheduler.cancel(EventType::VBLANK_END);
+    REQUIRE(scheduler.getNextEventTime() == Scheduler::NEVER);
+    REQUIRE_FALSE(scheduler.isDue(EventType::NMI, 1'000'000));
+  }
+}
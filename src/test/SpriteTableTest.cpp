@@ -0,0 +1,83 @@
+#include <catch2/catch_all.hpp>
+#include <array>
+#include <random>
+
+#define private public
+#include "../ppu/ppu.h"
+#include "../display/null_sink.h"
+
+struct Evaluation {
+  std::vector<Byte> secondaryOam;
+  int secondaryOamAddr;
+  Byte oamAddr;
+  Byte ppuStatus;
+};
+
+static Evaluation evaluate(PPU& ppu, bool useSpriteTable) {
+  OAM& oam{ ppu.oam };
+  std::fill(oam.secondaryOam.begin(), oam.secondaryOam.end(), 0xFF);
+  oam.spriteEvaluationEnd = false;
+  oam.secondaryOamAddr = 0;
+  oam.readOffset = 0;
+  oam.oamAddr = 0;
+  ppu.ppuStatus = 0;
+
+  if (!useSpriteTable || !oam.evaluateFromSpriteTable()) {
+    for (int cycle{65}; cycle <= 256 && !oam.spriteEvaluationEnd; cycle++)
+      oam.evaluateOAM();
+  }
+
+  return { oam.secondaryOam, oam.secondaryOamAddr, oam.oamAddr, ppu.ppuStatus };
+}
+
+TEST_CASE("Sprite table evaluation matches step by step evaluation") {
+  NullSink sink{};
+  PPU ppu{sink};
+  std::mt19937 random{ 16 };
+
+  for (int round{}; round < 50; round++) {
+    // Sprites bunched up in a few bands so that some lines have 8 or more of them
+    std::array<Byte, 256> page;
+    for (int i{}; i < 256; i++)
+      page[i] = i % 4 == 0 ? (random() % 4) * 60 + random() % 40 : random();
+    ppu.oam.DMA(page.data());
+
+    for (Byte ppuCtrl : { 0x00, 0x20 }) {
+      ppu.ppuCtrl = ppuCtrl;
+      int tableLines{};
+      for (int scanline{}; scanline < EmuConst::SCREEN_HEIGHT; scanline++) {
+        ppu.scanline = scanline;
+        const Evaluation stepped{ evaluate(ppu, false) };
+        const Evaluation table{ evaluate(ppu, true) };
+        tableLines += ppu.oam.spriteTable[scanline].count < 8;
+
+        REQUIRE(table.secondaryOam == stepped.secondaryOam);
+        REQUIRE(table.secondaryOamAddr == stepped.secondaryOamAddr);
+        REQUIRE(table.oamAddr == stepped.oamAddr);
+        REQUIRE(table.ppuStatus == stepped.ppuStatus);
+      }
+      REQUIRE(tableLines > 0);
+    }
+  }
+}
+
+TEST_CASE("Writing OAM while rendering falls back to step by step evaluation for the rest of the frame") {
+  NullSink sink{};
+  PPU ppu{sink};
+  ppu.ppuMask = 0b1'1000;
+  ppu.frame = 5;
+  ppu.scanline = 100;
+  ppu.oam.oamAddr = 0;
+  REQUIRE(ppu.oam.evaluateFromSpriteTable());
+
+  ppu.oam.writeOAMData(99);
+  ppu.oam.oamAddr = 0;
+  ppu.scanline = 101;
+  REQUIRE_FALSE(ppu.oam.evaluateFromSpriteTable());
+
+  // Sprite 0 now covers line 99 to 106 in the next frame
+  ppu.frame = 6;
+  REQUIRE(ppu.oam.evaluateFromSpriteTable());
+  REQUIRE(ppu.oam.secondaryOamAddr == 4);
+  REQUIRE(ppu.oam.secondaryOam[0] == 99);
+}
@@ -0,0 +1,49 @@
+#include <catch2/catch_all.hpp>
+#include <cstring>
+
+#define private public
+#include "../ppu/ppu.h"
+#include "../display/null_sink.h"
+
+TEST_CASE("Tile cache decodes rows of both bit planes") {
+  NullSink sink{};
+  PPU ppu{sink};
+
+  // Tile 1, row 2: low plane 1100'0001, high plane 1010'0011
+  ppu.memory[0x0012] = 0b1100'0001;
+  ppu.memory[0x001A] = 0b1010'0011;
+  ppu.tileCache.rebuild();
+
+  const Byte expected[8]{ 3, 1, 2, 0, 0, 0, 2, 3 };
+  REQUIRE(std::memcmp(ppu.tileCache.getRow(1, 2, false), expected, 8) == 0);
+
+  const Byte flipped[8]{ 3, 2, 0, 0, 0, 2, 1, 3 };
+  REQUIRE(std::memcmp(ppu.tileCache.getRow(1, 2, true), flipped, 8) == 0);
+
+  uint64_t bits;
+  std::memcpy(&bits, expected, 8);
+  REQUIRE(ppu.tileCache.getRowBits(1, 2, false) == bits);
+
+  for (int row{}; row < 8; row++)
+    for (int i{}; i < 8; i++)
+      REQUIRE(ppu.tileCache.getRow(0x1FF, row, false)[i] == 0);
+}
+
+TEST_CASE("Writing CHR through the PPU decodes the tile again") {
+  NullSink sink{};
+  PPU ppu{sink};
+  ppu.tileCache.rebuild();
+  REQUIRE(ppu.tileCache.getRow(0x100, 0, false)[0] == 0);
+
+  // Second pattern table, tile 0, row 0, leftmost pixel 1
+  ppu.writeMemory(0x1000, 0b1000'0000);
+  REQUIRE(ppu.tileCache.getRow(0x100, 0, false)[0] == 1);
+  REQUIRE(ppu.tileCache.getRow(0x100, 0, true)[7] == 1);
+
+  ppu.writeMemory(0x1008, 0b1000'0000);
+  REQUIRE(ppu.tileCache.getRow(0x100, 0, false)[0] == 3);
+
+  // Writes outside the pattern tables leave the cache alone
+  ppu.writeMemory(0x2000, 0xFF);
+  REQUIRE(ppu.tileCache.getRow(0x000, 0, false)[0] == 0);
+}
@@ -0,0 +1,60 @@
+#include <catch2/catch_all.hpp>
+#include <sstream>
+#include <string>
+
+#include "../../cpu/profiler.h"
+
+TEST_CASE("ExecutionProfiler counts per opcode, addressing mode and PC") {
+  ExecutionProfiler profiler{};
+  profiler.record(0x8000, 0xA5, 3);          // LDA $10
+  profiler.record(0x8002, 0xF0, 3);          // BEQ taken
+  profiler.recordRepeated(0x8000, 0xA5, 10, 30);
+  profiler.recordRepeated(0x8002, 0xF0, 10, 30);
+  profiler.record(0x9000, 0xA5, 3);
+
+  REQUIRE(profiler.getTotalCount() == 23);
+  REQUIRE(profiler.getTotalCycles() == 69);
+
+  std::ostringstream csv{};
+  profiler.exportCSV(csv);
+  const std::string text{ csv.str() };
+  CHECK(text.find("section,key,instruction,count,cycles\n") == 0);
+  CHECK(text.find("opcode,$A5,LDA ZERO_PAGE,12,36\n") != std::string::npos);
+  CHECK(text.find("opcode,$F0,BEQ RELATIVE,11,33\n") != std::string::npos);
+  CHECK(text.find("mode,ZERO_PAGE,,12,36\n") != std::string::npos);
+  CHECK(text.find("pc,$8000,LDA,11,33\n") != std::string::npos);
+  CHECK(text.find("pc,$9000,LDA,1,3\n") != std::string::npos);
+
+  std::ostringstream report{};
+  profiler.printReport(report, 1);
+  CHECK(report.str().find("$A5 LDA ZERO_PAGE") != std::string::npos);
+  CHECK(report.str().find("$F0 BEQ") == std::string::npos);
+
+  profiler.reset();
+  REQUIRE(profiler.getTotalCount() == 0);
+  REQUIRE(profiler.getTotalCycles() == 0);
+}
+
+TEST_CASE("ExecutionProfiler counts NMI cycles apart from the instructions") {
+  ExecutionProfiler profiler{};
+  profiler.record(0x8000, 0xA5, 3);
+  profiler.recordNMI(7);
+  profiler.recordNMI(7);
+
+  REQUIRE(profiler.getTotalCount() == 1);
+  REQUIRE(profiler.getTotalCycles() == 17);
+  REQUIRE(profiler.getNMICount() == 2);
+  REQUIRE(profiler.getNMICycles() == 14);
+
+  std::ostringstream csv{};
+  profiler.exportCSV(csv);
+  CHECK(csv.str().find("interrupt,NMI,,2,14\n") != std::string::npos);
+
+  std::ostringstream report{};
+  profiler.printReport(report, 3);
+  CHECK(report.str().find("NMI") != std::string::npos);
+
+  profiler.reset();
+  REQUIRE(profiler.getNMICount() == 0);
+  REQUIRE(profiler.getTotalCycles() == 0);
+}
@@ -0,0 +1,80 @@
+#include <catch2/catch_all.hpp>
+#include <sstream>
+#include <string>
+
+#define private public
+#include "../../cpu/cpu.h"
+#include "../../cpu/trace.h"
+#include "../../cpu/disassembler.h"
+#include "../../display/null_sink.h"
+
+static TraceRecord makeRecord(Word pc) {
+  return {7, pc, 0xEA, 0x00, 0x00, 0x00, 0x00, 0x00, 0x24, 0xFD, 0, 21};
+}
+
+TEST_CASE("TraceBuffer keeps the most recent records") {
+  TraceBuffer trace{5};
+  REQUIRE(trace.getCapacity() == 8);
+  REQUIRE(trace.size() == 0);
+
+  for (Word pc{}; pc < 20; pc++)
+    trace.record(makeRecord(pc));
+
+  REQUIRE(trace.size() == 8);
+  for (std::size_t i{}; i < trace.size(); i++)
+    CHECK(trace[i].pc == 12 + i);
+
+  trace.clear();
+  REQUIRE(trace.size() == 0);
+}
+
+TEST_CASE("Disassembler uses nestest syntax") {
+  CHECK(disassemble(0xC000, 0x4C, 0xF5, 0xC5) == "JMP $C5F5");
+  CHECK(disassemble(0xC000, 0xA9, 0x10, 0x00) == "LDA #$10");
+  CHECK(disassemble(0xC000, 0xB1, 0x80, 0x00) == "LDA ($80),Y");
+  CHECK(disassemble(0xC000, 0x0A, 0x00, 0x00) == "ASL A");
+  CHECK(disassemble(0xC72A, 0xD0, 0xFC, 0x00) == "BNE $C728");
+  CHECK(disassemble(0xC000, 0x02, 0x00, 0x00) == "???");
+
+  CHECK(getInstructionLength(0xEA) == 1);
+  CHECK(getInstructionLength(0xB1) == 2);
+  CHECK(getInstructionLength(0x6C) == 3);
+}
+
+TEST_CASE("Executed instructions are exported in nestest.log format") {
+  NullSink sink{};
+  PPU ppu{sink};
+  InputHandler inputHandler{};
+  CPU cpu{ppu, inputHandler};
+  TraceBuffer trace{16};
+  cpu.setTraceBuffer(&trace);
+
+  cpu.programCounter = 0xC000;
+  cpu.stackPointer = 0xFD;
+  cpu.interruptDisable = true;
+  // LDA #$10, STA $0200, JMP $C000
+  const Byte program[]{ 0xA9, 0x10, 0x8D, 0x00, 0x02, 0x4C, 0x00, 0xC0 };
+  for (int i{}; i < sizeof(program); i++)
+    cpu.memory[0xC000 + i] = program[i];
+
+  for (int i{}; i < 4; i++)
+    cpu.executeNextClock();
+
+  REQUIRE(trace.size() == 4);
+
+  std::ostringstream all{};
+  exportNestestLog(trace, all);
+  std::istringstream lines{ all.str() };
+  std::string line{};
+  std::getline(lines, line);
+  CHECK(line.rfind("C000  A9 10     LDA #$10                        A:00 X:00 Y:00 P:24 SP:FD", 0) == 0);
+  std::getline(lines, line);
+  CHECK(line == "C002  8D 00 02  STA $0200                       A:10 X:00 Y:00 P:24 SP:FD PPU:  0,  5 CYC:9");
+
+  SECTION("PC filter") {
+    std::ostringstream filtered{};
+    exportNestestLog(trace, filtered, 0xC002, 0xC004);
+    CHECK(filtered.str().rfind("C002  8D 00 02  STA $0200", 0) == 0);
+    CHECK(filtered.str().find("C000") == std::string::npos);
+  }
+}
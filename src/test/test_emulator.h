@@ -0,0 +1,61 @@
+#ifndef NESEMULATOR_TEST_EMULATOR_H
+#define NESEMULATOR_TEST_EMULATOR_H
+
+#include <catch2/catch_all.hpp>
+#include <array>
+#include <string>
+
+#include "../constants.h"
+#include "../cpu/cpu.h"
+#include "../ppu/ppu.h"
+#include "../input_handler/input_handler.h"
+#include "../initializer/initializer.h"
+#include "../display/memory_sink.h"
+
+/**
+ * \brief ROMs in TEST_ROM_DIR whose frames the rendering tests compare, use with GENERATE(from_range(...))
+ */
+inline constexpr std::array<const char*, 4> RENDER_TEST_ROMS{
+  "supermariobros.nes", "kungfu.nes", "mariobros.nes", "pacman.nes"
+};
+
+inline std::string getTestRomPath(const std::string& name) {
+  return std::string{TEST_ROM_DIR} + "/" + name;
+}
+
+/**
+ * \brief A complete emulator instance drawing into a Sink, nothing is shared between two of these
+ */
+template <typename Sink>
+struct BasicEmulator {
+  Sink sink{};
+  PPU ppu{sink};
+  InputHandler inputHandler{};
+  CPU cpu{ppu, inputHandler};
+
+  /**
+   * \brief Nothing loaded, for tests that load the ROM themselves
+   */
+  BasicEmulator() = default;
+
+  /**
+   * \brief Load romPath, failing the test if it cannot be, and execute the start up sequence
+   */
+  explicit BasicEmulator(const std::string& romPath) {
+    Initializer initializer{cpu, ppu};
+    REQUIRE(initializer.loadFile(romPath).empty());
+    cpu.executeStartUpSequence();
+  }
+
+  /**
+   * \brief Run the CPU for a frame the way the front ends do, then bring the PPU up to date
+   */
+  void runFrame() {
+    cpu.run(cpu.totalCycle + EmuConst::FRAME_CYCLES);
+    cpu.syncPPU();
+  }
+};
+
+using Emulator = BasicEmulator<MemorySink>;
+
+#endif
@@ -0,0 +1,155 @@
+#include "emulation_thread.h"
+
+EmulationThread::EmulationThread(CPU& cpu, PPU& ppu, InputHandler& inputHandler, PacingMode pacingMode,
+                                 int presentEvery) : cpu{cpu}, ppu{ppu}, inputHandler{inputHandler},
+framePacer{pacingMode}, fastForward{presentEvery}, hostStats{}, inputs{}, pendingInput{}, hasPendingInput{}, debugStates{}, isFastForward{},
+isDebugStateEnabled{}, fastForwardSpeed{}, frameCount{}, isPaused{}, isStopping{} {}
+
+EmulationThread::~EmulationThread() {
+  stop();
+}
+
+void EmulationThread::start() {
+  if (thread.joinable())
+    return;
+
+  isStopping.store(false);
+  thread = std::thread{&EmulationThread::run, this};
+}
+
+void EmulationThread::stop() {
+  if (!thread.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock{pauseMutex};
+    isStopping.store(true);
+  }
+  pauseChanged.notify_one();
+  thread.join();
+}
+
+bool EmulationThread::pushInput(Byte buttons) {
+  return inputs.push({frameCount.load(std::memory_order_relaxed), buttons});
+}
+
+bool EmulationThread::pushInput(Byte buttons, uint64_t frame) {
+  return inputs.push({frame, buttons});
+}
+
+void EmulationThread::setPaused(bool paused) {
+  {
+    std::lock_guard<std::mutex> lock{pauseMutex};
+    isPaused = paused;
+  }
+  pauseChanged.notify_one();
+}
+
+void EmulationThread::setFastForward(bool enabled) {
+  isFastForward.store(enabled, std::memory_order_relaxed);
+}
+
+double EmulationThread::getFastForwardSpeed() const {
+  return fastForwardSpeed.load(std::memory_order_relaxed);
+}
+
+void EmulationThread::setDebugStateEnabled(bool enabled) {
+  isDebugStateEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool EmulationThread::acquireDebugState() {
+  return debugStates.acquire();
+}
+
+const std::vector<Byte>& EmulationThread::getDebugState() const {
+  return debugStates.getFront();
+}
+
+uint64_t EmulationThread::getFrameCount() const {
+  return frameCount.load(std::memory_order_relaxed);
+}
+
+const HostStats& EmulationThread::getHostStats() const {
+  return hostStats;
+}
+
+bool EmulationThread::waitWhilePaused() {
+  std::unique_lock<std::mutex> lock{pauseMutex};
+  if (!isPaused)
+    return false;
+
+  pauseChanged.wait(lock, [this] { return !isPaused || isStopping.load(); });
+  return true;
+}
+
+void EmulationThread::applyInput(uint64_t frame) {
+  bool isApplied{false};
+  while (hasPendingInput || inputs.pop(pendingInput)) {
+    hasPendingInput = true;
+    // States are in frame order, so once one is not late none after it are
+    const bool isLate{ pendingInput.frame + MAX_INPUT_LAG < frame };
+    if (pendingInput.frame > frame || (isApplied && !isLate))
+      break;
+
+    inputHandler.setButtons(pendingInput.buttons);
+    hasPendingInput = false;
+    isApplied = true;
+  }
+}
+
+void EmulationThread::run() {
+  cpu.setHostStats(&hostStats);
+  framePacer.setHostStats(&hostStats);
+  framePacer.reset();
+  hostStats.reset();
+
+  uint64_t lastTotalCycle{cpu.totalCycle};
+  bool wasFastForward{false};
+  while (true) {
+    // Deadlines missed while paused do not count
+    if (waitWhilePaused())
+      framePacer.reset();
+    if (isStopping.load(std::memory_order_relaxed))
+      break;
+
+    const bool isFastForwardFrame{ isFastForward.load(std::memory_order_relaxed) };
+    if (isFastForwardFrame && !wasFastForward)
+      fastForward.reset();
+    if (!isFastForwardFrame && wasFastForward)
+      framePacer.reset();
+    wasFastForward = isFastForwardFrame;
+    const bool isPresented{ !isFastForwardFrame || fastForward.isNextFramePresented() };
+
+    applyInput(frameCount.load(std::memory_order_relaxed));
+
+    // Execute CPU until more than 29833 cycles have passed, the frame starting in it is only drawn if presented
+    const uint64_t drawnFrameCount{ ppu.getDrawnFrameCount() };
+    ppu.setRenderEnabled(isPresented);
+    cpu.run(lastTotalCycle + EmuConst::FRAME_CYCLES);
+    const uint64_t frameCycles{ cpu.totalCycle - lastTotalCycle };
+    lastTotalCycle = cpu.totalCycle;
+    cpu.syncPPU();
+
+    // The frame completed in the chunk may have started in an earlier one, so whether it was presented is read back
+    // from the PPU rather than taken from isPresented
+    const bool isFramePresented{ ppu.getDrawnFrameCount() != drawnFrameCount };
+    if (isFramePresented && isDebugStateEnabled.load(std::memory_order_relaxed)) {
+      std::vector<Byte>& state{ debugStates.getBack() };
+      state.clear();
+      ppu.saveState(state);
+      debugStates.publish();
+    }
+
+    if (isFastForwardFrame) {
+      if (fastForward.endFrame(frameCycles))
+        fastForwardSpeed.store(fastForward.getSpeed(), std::memory_order_relaxed);
+    } else {
+      framePacer.waitForNextFrame();
+    }
+    hostStats.endFrame(frameCycles);
+    frameCount.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  cpu.setHostStats(nullptr);
+  framePacer.setHostStats(nullptr);
+}
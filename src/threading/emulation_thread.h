@@ -0,0 +1,151 @@
+#ifndef NESEMULATOR_EMULATION_THREAD_H
+#define NESEMULATOR_EMULATION_THREAD_H
+
+#include "../cpu/cpu.h"
+#include "../ppu/ppu.h"
+#include "../input_handler/input_handler.h"
+#include "../frame_pacer/frame_pacer.h"
+#include "../stats/host_stats.h"
+#include "triple_buffer.h"
+#include "spsc_queue.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * \brief Runs the CPU and PPU frame by frame on their own thread, paced to the NTSC frame rate
+ * \note The frames reach the presentation thread through the sink of the PPU (TripleBufferSink). Controller input
+ * comes the other way through a queue of button states, each tagged with the frame it was meant for: at the start of a
+ * frame at most one due state is applied and holds until the next one, so every change lasts at least a frame. States
+ * more than MAX_INPUT_LAG frames behind are applied at once, the latest winning, so input piling up while the thread
+ * is slow does not turn into lag. Which frame a state applies to only depends on the tags and the order of the states,
+ * never on where in a frame the host thread happened to be.
+ * Other threads must not touch cpu, ppu or inputHandler between start() and stop()
+ */
+class EmulationThread {
+public:
+  static constexpr size_t INPUT_QUEUE_SIZE{ 256 };
+  static constexpr uint64_t MAX_INPUT_LAG{ 2 }; // Frames an input state may be applied after the frame it was meant for
+
+  /**
+   * \param presentEvery see FastForward
+   */
+  EmulationThread(CPU& cpu, PPU& ppu, InputHandler& inputHandler, PacingMode pacingMode, int presentEvery = 0);
+
+  /**
+   * \brief Stops the thread if still running
+   */
+  ~EmulationThread();
+
+  EmulationThread(const EmulationThread&) = delete;
+  EmulationThread& operator=(const EmulationThread&) = delete;
+
+  /**
+   * \brief Start emulating from where cpu and ppu are, the start up sequence must have been executed
+   */
+  void start();
+
+  /**
+   * \brief Stop after the frame being emulated and wait for the thread to end
+   */
+  void stop();
+
+  /**
+   * \brief Queue the buttons pressed from the next frame on, Button values or'ed together
+   * \return false if the queue is full and buttons was dropped
+   */
+  bool pushInput(Byte buttons);
+
+  /**
+   * \brief Queue the buttons pressed from frame on, counted from start(), e.g. to replay recorded input
+   * \note frame must not be lower than that of the states queued before
+   */
+  bool pushInput(Byte buttons, uint64_t frame);
+
+  /**
+   * \brief Pause or resume emulation, the thread sleeps while paused
+   */
+  void setPaused(bool paused);
+
+  /**
+   * \brief Run as fast as possible, drawing only the frames FastForward picks
+   */
+  void setFastForward(bool enabled);
+
+  /**
+   * \brief Get the speed reached in fast forward, see FastForward::getSpeed()
+   */
+  [[nodiscard]] double getFastForwardSpeed() const;
+
+  /**
+   * \brief Publish PPU::saveState() after every drawn frame, for debug views on other threads
+   */
+  void setDebugStateEnabled(bool enabled);
+
+  /**
+   * \brief Take the latest published PPU state
+   * \return false if none was published since the last call, getDebugState() is unchanged then
+   */
+  bool acquireDebugState();
+  [[nodiscard]] const std::vector<Byte>& getDebugState() const;
+
+  /**
+   * \brief Get the number of frames emulated since start()
+   */
+  [[nodiscard]] uint64_t getFrameCount() const;
+
+  /**
+   * \brief Get the host time of the emulation thread, only to be read once stopped
+   */
+  [[nodiscard]] const HostStats& getHostStats() const;
+
+private:
+  void run();
+
+  /**
+   * \brief Block while paused
+   * \return true if the thread was paused
+   */
+  bool waitWhilePaused();
+
+  /**
+   * \brief Apply the queued input states due at the start of frame
+   */
+  void applyInput(uint64_t frame);
+
+  struct InputState {
+    uint64_t frame;
+    Byte buttons;
+  };
+
+  CPU& cpu;
+  PPU& ppu;
+  InputHandler& inputHandler;
+
+  // Only used by the emulation thread
+  FramePacer framePacer;
+  FastForward fastForward;
+  HostStats hostStats;
+
+  SpscQueue<InputState, INPUT_QUEUE_SIZE> inputs;
+  InputState pendingInput; // Taken from inputs but not due yet
+  bool hasPendingInput;
+  TripleBuffer<std::vector<Byte>> debugStates;
+
+  std::atomic<bool> isFastForward;
+  std::atomic<bool> isDebugStateEnabled;
+  std::atomic<double> fastForwardSpeed;
+  std::atomic<uint64_t> frameCount;
+
+  std::mutex pauseMutex;
+  std::condition_variable pauseChanged;
+  bool isPaused;
+  std::atomic<bool> isStopping; // Written under pauseMutex too, so waiting for a resume does not miss it
+
+  std::thread thread;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef NESEMULATOR_SPSC_QUEUE_H
+#define NESEMULATOR_SPSC_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * \brief Lock-free queue of at most CAPACITY - 1 values from a single producer thread to a single consumer thread
+ */
+template <typename T, size_t CAPACITY>
+class SpscQueue {
+public:
+  SpscQueue() : items{}, head{}, tail{} {}
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  /**
+   * \brief Called by the producer
+   * \return false if the queue is full, value is dropped then
+   */
+  bool push(const T& value) {
+    const size_t currentTail{ tail.load(std::memory_order_relaxed) };
+    const size_t nextTail{ (currentTail + 1) % CAPACITY };
+    if (nextTail == head.load(std::memory_order_acquire))
+      return false;
+
+    items[currentTail] = value;
+    tail.store(nextTail, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * \brief Called by the consumer
+   * \return false if the queue is empty, value is unchanged then
+   */
+  bool pop(T& value) {
+    const size_t currentHead{ head.load(std::memory_order_relaxed) };
+    if (currentHead == tail.load(std::memory_order_acquire))
+      return false;
+
+    value = items[currentHead];
+    head.store((currentHead + 1) % CAPACITY, std::memory_order_release);
+    return true;
+  }
+
+private:
+  std::array<T, CAPACITY> items;
+
+  // Written by one side each, kept on separate cache lines so the 2 threads do not invalidate each other's
+  alignas(64) std::atomic<size_t> head; // Next value to pop
+  alignas(64) std::atomic<size_t> tail; // Next slot to push into
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef NESEMULATOR_TRIPLE_BUFFER_H
+#define NESEMULATOR_TRIPLE_BUFFER_H
+
+#include <array>
+#include <atomic>
+
+/**
+ * \brief Hands the latest of a stream of values from one thread to another without either ever waiting
+ * \note The producer fills the back buffer and publishes it, the consumer acquires the latest published buffer as
+ * its front buffer. The third buffer sits in between, so a slow consumer only misses values and never blocks the
+ * producer. A buffer is reused as is, the producer has to overwrite what it needs
+ */
+template <typename T>
+class TripleBuffer {
+public:
+  explicit TripleBuffer(const T& initial = T{}) : buffers{initial, initial, initial}, back{0}, middle{1}, front{2} {}
+
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  // Producer
+  T& getBack() {
+    return buffers[back];
+  }
+
+  /**
+   * \brief Make the back buffer the latest value and continue in another buffer
+   */
+  void publish() {
+    back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+  }
+
+  // Consumer
+  /**
+   * \brief Take the latest published value as the front buffer
+   * \return false if nothing was published since the last acquire(), the front buffer is unchanged then
+   */
+  bool acquire() {
+    if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+      return false;
+
+    front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+    return true;
+  }
+
+  const T& getFront() const {
+    return buffers[front];
+  }
+
+private:
+  static constexpr int INDEX_MASK{ 0b011 };
+  static constexpr int FRESH{ 0b100 }; // Set in middle when it holds a value the consumer has not acquired yet
+
+  std::array<T, 3> buffers;
+  int back; // Only used by the producer
+  std::atomic<int> middle;
+  int front; // Only used by the consumer
+};
+
+#endif
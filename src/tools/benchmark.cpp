@@ -0,0 +1,115 @@
+// Headless benchmark: runs a ROM without any presentation layer and reports emulation throughput
+#include "../cpu/cpu.h"
+#include "../ppu/ppu.h"
+#include "../initializer/initializer.h"
+#include "../display/null_sink.h"
+#include "../ppu/render_pipeline.h"
+#include "../stats/host_stats.h"
+#include "../simd.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+
+int main(int argc, char** argv) {
+  const char* program{ argv[0] };
+
+  // --dots renders every scanline dot by dot, to measure the dot renderer on its own
+  // --scalar runs the line kernels without SIMD, to measure what the SIMD kernels save
+  // --skip-render runs every frame without drawing it, as fast-forward and RAM-only bots do
+  // --pipelined draws the frames on a render thread while the next one is emulated
+  bool dotsOnly{};
+  bool skipRender{};
+  bool pipelined{};
+  while (argc > 1 && std::string{argv[1]}.rfind("--", 0) == 0) {
+    const std::string option{ argv[1] };
+    if (option == "--dots") {
+      dotsOnly = true;
+    } else if (option == "--scalar") {
+      setSimdLevel(SimdLevel::SCALAR);
+    } else if (option == "--skip-render") {
+      skipRender = true;
+    } else if (option == "--pipelined") {
+      pipelined = true;
+    } else {
+      printf("Unknown option %s\n", argv[1]);
+      return -1;
+    }
+    argc--;
+    argv++;
+  }
+
+  if (argc < 2) {
+    printf("Usage: %s [--dots] [--scalar] [--skip-render] [--pipelined] <rom> [frames] [stats.json]\n", program);
+    return -1;
+  }
+
+  const int frames{ argc > 2 ? std::atoi(argv[2]) : 600 };
+
+  NullSink sink{};
+  PPU ppu{sink};
+  InputHandler inputHandler{};
+  CPU cpu{ppu, inputHandler};
+  ppu.setScanlineRenderer(!dotsOnly);
+  ppu.setRenderEnabled(!skipRender);
+  Initializer initializer{cpu, ppu};
+
+  std::string res{ initializer.loadFile(argv[1]) };
+  if (!res.empty()) {
+    printf("Error: %s\n", res.c_str());
+    return -1;
+  }
+
+  cpu.executeStartUpSequence();
+
+  std::unique_ptr<RenderPipeline> pipeline{};
+  if (pipelined)
+    pipeline = std::make_unique<RenderPipeline>(ppu, sink);
+
+  // Timing every PPU catch up costs a little, so only measure the split when asked to
+  HostStats hostStats{};
+  if (argc > 3)
+    cpu.setHostStats(&hostStats);
+
+  uint64_t lastTotalCycle{cpu.totalCycle};
+  const uint64_t startCycle{cpu.totalCycle};
+  const uint64_t startClock{ppu.clock};
+  auto start{ std::chrono::steady_clock::now() };
+
+  for (int frame{}; frame < frames; frame++) {
+    // Same chunking as the main loop, run until more than 29833 cycles have passed
+    cpu.run(lastTotalCycle + EmuConst::FRAME_CYCLES);
+    if (argc > 3)
+      hostStats.endFrame(cpu.totalCycle - lastTotalCycle);
+    lastTotalCycle = cpu.totalCycle;
+  }
+
+  cpu.syncPPU();
+  if (pipeline)
+    pipeline->flush();
+  auto end{ std::chrono::steady_clock::now() };
+  const double seconds{ std::chrono::duration<double>(end - start).count() };
+  const double emulatedSeconds{ static_cast<double>(cpu.totalCycle - startCycle) / EmuConst::CPU_FREQUENCY };
+
+  printf("%s\n", argv[1]);
+  printf("  frames:            %d (%llu rendered)\n", frames, static_cast<unsigned long long>(sink.getFrameCount()));
+  printf("  host time:         %.3f s\n", seconds);
+  printf("  frames/s:          %.1f\n", frames / seconds);
+  printf("  instructions/s:    %.0f\n", cpu.instructionCount / seconds);
+  printf("  ppu dots/s:        %.0f%s\n", (ppu.clock - startClock) / seconds, dotsOnly ? " (dot renderer only)" : "");
+  printf("  speed:             %.2fx real time\n", emulatedSeconds / seconds);
+  printf("  line kernels:      %s\n", getSimdLevelName(getSimdLevel()));
+  printf("  idle skipped:      %.1f%% of cycles\n", 100.0 * cpu.skippedCycles / (cpu.totalCycle - startCycle));
+
+  if (argc > 3) {
+    printf("  cpu / ppu / sink:  %.3f / %.3f / %.3f s\n", hostStats.getNanoseconds(Subsystem::CPU) / 1e9,
+           hostStats.getNanoseconds(Subsystem::PPU) / 1e9, hostStats.getNanoseconds(Subsystem::DISPLAY) / 1e9);
+    printf("  frame time:        p50 %.1f ms, p95 %.1f ms, p99 %.1f ms\n", hostStats.getFrameTimePercentile(50),
+           hostStats.getFrameTimePercentile(95), hostStats.getFrameTimePercentile(99));
+    std::ofstream statsFile{argv[3]};
+    hostStats.writeJSON(statsFile);
+  }
+  return 0;
+}
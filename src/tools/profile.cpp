@@ -0,0 +1,88 @@
+// Headless profiler: runs ROMs without any presentation layer and reports where the emulated program spends its
+// cycles, per opcode, addressing mode and PC. Only built with NES_PROFILER
+#include "../cpu/cpu.h"
+#include "../ppu/ppu.h"
+#include "../initializer/initializer.h"
+#include "../display/null_sink.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static std::string getFileName(const std::string& path) {
+  const size_t slash{ path.find_last_of("/\\") };
+  return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+static bool profileRom(const std::string& romPath, int frames, int topN, const std::string& outDir) {
+  NullSink sink{};
+  PPU ppu{sink};
+  InputHandler inputHandler{};
+  CPU cpu{ppu, inputHandler};
+  Initializer initializer{cpu, ppu};
+
+  std::string res{ initializer.loadFile(romPath) };
+  if (!res.empty()) {
+    printf("Error: %s: %s\n", romPath.c_str(), res.c_str());
+    return false;
+  }
+
+  cpu.executeStartUpSequence();
+
+  uint64_t lastTotalCycle{cpu.totalCycle};
+  for (int frame{}; frame < frames; frame++) {
+    cpu.run(lastTotalCycle + EmuConst::FRAME_CYCLES);
+    lastTotalCycle = cpu.totalCycle;
+  }
+
+  const ExecutionProfiler& profiler{ cpu.getProfiler() };
+  const std::string csvPath{ outDir + "/" + getFileName(romPath) + ".profile.csv" };
+  std::ofstream csv{csvPath};
+  if (!csv) {
+    printf("Error: cannot write %s\n", csvPath.c_str());
+    return false;
+  }
+  profiler.exportCSV(csv);
+
+  printf("%s\n", romPath.c_str());
+  printf("  frames:            %d\n", frames);
+  printf("  instructions:      %llu\n", static_cast<unsigned long long>(profiler.getTotalCount()));
+  printf("  cycles:            %llu\n", static_cast<unsigned long long>(profiler.getTotalCycles()));
+  printf("  nmis:              %llu\n", static_cast<unsigned long long>(profiler.getNMICount()));
+  printf("  csv:               %s\n", csvPath.c_str());
+  fflush(stdout);
+  profiler.printReport(std::cout, topN);
+  std::cout << std::endl;
+  return true;
+}
+
+int main(int argc, char** argv) {
+  int frames{ 600 };
+  int topN{ 10 };
+  std::string outDir{ "." };
+  std::vector<std::string> roms{};
+
+  for (int i{ 1 }; i < argc; i++) {
+    if (!strcmp(argv[i], "-f") && i + 1 < argc)
+      frames = std::atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+      topN = std::atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+      outDir = argv[++i];
+    else
+      roms.emplace_back(argv[i]);
+  }
+
+  if (roms.empty()) {
+    printf("Usage: %s [-f frames] [-n top] [-o outdir] <rom>...\n", argv[0]);
+    return -1;
+  }
+
+  bool ok{ true };
+  for (const std::string& rom : roms)
+    ok = profileRom(rom, frames, topN, outDir) && ok;
+  return ok ? 0 : -1;
+}
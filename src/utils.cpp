@@ -9,7 +9,7 @@ void setBit(uint8_t& variable, int lowPos, int highPos, uint8_t input) {
   assert(0 <= lowPos && lowPos <= 7 && "lowPos is out of bound");
   assert(0 <= highPos && highPos <= 7 && "highPos is out of bound");
 
-  const uint8_t mask{ static_cast<uint8_t>(0xff - std::pow(2, highPos + 1) + std::pow(2, lowPos)) };
+  const uint8_t mask{ static_cast<uint8_t>(~((1u << (highPos + 1)) - (1u << lowPos))) };
   variable &= mask;
   variable |= input << lowPos;
 }
@@ -19,7 +19,7 @@ void setBit(uint16_t& variable, int lowPos, int highPos, uint16_t input) {
   assert(0 <= lowPos && lowPos <= 15 && "lowPos is out of bound");
   assert(0 <= highPos && highPos <= 15 && "highPos is out of bound");
 
-  const uint16_t mask{ static_cast<uint16_t>(0xffff - std::pow(2, highPos + 1) + std::pow(2, lowPos)) };
+  const uint16_t mask{ static_cast<uint16_t>(~((1u << (highPos + 1)) - (1u << lowPos))) };
   variable &= mask;
   variable |= input << lowPos;
 }
@@ -30,7 +30,7 @@ void clearBit(uint8_t& variable, int lowPos, int highPos) {
   assert(0 <= lowPos && lowPos <= 7 && "lowPos is out of bound");
   assert(0 <= highPos && highPos <= 7 && "highPos is out of bound");
 
-  const uint8_t mask{ static_cast<uint8_t>(0xffff - std::pow(2, highPos + 1) + std::pow(2, lowPos)) };
+  const uint8_t mask{ static_cast<uint8_t>(~((1u << (highPos + 1)) - (1u << lowPos))) };
   variable &= mask;
 }
 
@@ -39,7 +39,7 @@ void clearBit(uint16_t& variable, int lowPos, int highPos) {
   assert(0 <= lowPos && lowPos <= 15 && "lowPos is out of bound");
   assert(0 <= highPos && highPos <= 15 && "highPos is out of bound");
 
-  const uint16_t mask{ static_cast<uint16_t>(0xffff - std::pow(2, highPos + 1) + std::pow(2, lowPos)) };
+  const uint16_t mask{ static_cast<uint16_t>(~((1u << (highPos + 1)) - (1u << lowPos))) };
   variable &= mask;
 }
 
@@ -49,7 +49,7 @@ uint8_t extractBit(uint8_t input, int lowPos, int highPos) {
   assert(0 <= lowPos && lowPos <= 7 && "lowPos is out of bound");
   assert(0 <= highPos && highPos <= 7 && "highPos is out of bound");
 
-  const uint8_t mask{ static_cast<uint8_t>(std::pow(2, highPos + 1) - std::pow(2, lowPos)) };
+  const uint8_t mask{ static_cast<uint8_t>((1u << (highPos + 1)) - (1u << lowPos)) };
   input &= mask;
   return input >> lowPos;
 }
@@ -59,7 +59,7 @@ uint16_t extractBit(uint16_t input, int lowPos, int highPos) {
   assert(0 <= lowPos && lowPos <= 15 && "lowPos is out of bound");
   assert(0 <= highPos && highPos <= 15 && "highPos is out of bound");
 
-  const uint16_t mask{ static_cast<uint16_t>(std::pow(2, highPos + 1) - std::pow(2, lowPos)) };
+  const uint16_t mask{ static_cast<uint16_t>((1u << (highPos + 1)) - (1u << lowPos)) };
   input &= mask;
   return input >> lowPos;
 }
\ No newline at end of file